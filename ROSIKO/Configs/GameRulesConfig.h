@@ -139,10 +139,10 @@ public:
 
 	// === COMBATTIMENTO ===
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (ClampMin = "1"))
 	int32 MaxAttackDice = 3;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat", meta = (ClampMin = "1"))
 	int32 MaxDefenseDice = 2;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Combat")
@@ -0,0 +1,13 @@
+#include "MapGenerationConfig.h"
+
+void UMapGenerationConfig::PostLoad()
+{
+    Super::PostLoad();
+
+    // Migrazione da bUseJumpFloodAlgorithm: gli asset che avevano scelto brute force restano su brute force
+    if (!bUseJumpFloodAlgorithm_DEPRECATED)
+    {
+        VoronoiAlgorithm = EVoronoiAlgorithm::BruteForce;
+        bUseJumpFloodAlgorithm_DEPRECATED = true;
+    }
+}
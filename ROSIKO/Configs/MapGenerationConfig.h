@@ -4,6 +4,15 @@
 #include "Engine/DataAsset.h"
 #include "MapGenerationConfig.generated.h"
 
+// Algoritmo usato per partizionare i continenti in territori (Voronoi sulla griglia)
+UENUM(BlueprintType)
+enum class EVoronoiAlgorithm : uint8
+{
+    JumpFlood               UMETA(DisplayName = "Jump Flood (approssimato)"),
+    BruteForce              UMETA(DisplayName = "Brute Force (celle x seed)"),
+    ExactDistanceTransform  UMETA(DisplayName = "Exact Distance Transform")
+};
+
 USTRUCT(BlueprintType)
 struct FContinentDefinition
 {
@@ -47,6 +56,8 @@ class ROSIKO_API UMapGenerationConfig : public UPrimaryDataAsset
     GENERATED_BODY()
 
 public:
+    virtual void PostLoad() override;
+
     // Quanti territori totali (fallback se non usiamo setup continenti)
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Generation")
     int32 NumTerritories = 70;
@@ -87,12 +98,13 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Visuals")
     TSubclassOf<AActor> TerritoryClass;
 
-    // Range variazione altezza per territorio (ogni territorio avrà un offset Z casuale in questo range)
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Depth")
+    // Range variazione altezza per territorio (ogni territorio avrà un offset Z casuale in questo range).
+    // Le altezze sono quantizzate in int16 a passi di 0.01: territorio + cella deve restare entro +/- 327.67
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Depth", meta = (ClampMin = "-300.0", ClampMax = "300.0"))
     FVector2D TerritoryHeightRange = FVector2D(0.0f, 50.0f);
 
     // Range variazione altezza per singola cella (ogni cubetto avrà un offset aggiuntivo in questo range)
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Depth")
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Depth", meta = (ClampMin = "-25.0", ClampMax = "25.0"))
     FVector2D CellHeightRange = FVector2D(-5.0f, 5.0f);
 
     // Range di variazione della luminosità per ogni territorio (0-1, dove 1.0 = colore pieno, 0.5 = 50% più scuro)
@@ -107,7 +119,34 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Depth", meta = (ClampMin = "0.0", ClampMax = "10.0"))
     float HeightDifferenceThreshold = 0.01f;
 
-    // Usa Jump Flood Algorithm per Voronoi (più veloce per griglie grandi [GridResolution > 1000 e NumTerritories > 200])
+    // Algoritmo Voronoi per i territori.
+    // JumpFlood: O(N log N), può sbagliare qualche cella sui confini.
+    // BruteForce: O(celle x seed), solo per confronto.
+    // ExactDistanceTransform: O(N) separabile (Felzenszwalb-Huttenlocher), confini esatti.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Advanced")
+    EVoronoiAlgorithm VoronoiAlgorithm = EVoronoiAlgorithm::JumpFlood;
+
+    // DEPRECATO: sostituito da VoronoiAlgorithm. Letto solo dagli asset salvati prima del cambio:
+    // false viene migrato a BruteForce in PostLoad (true coincide con il default JumpFlood)
+    UPROPERTY(meta = (DeprecatedProperty, DeprecationMessage = "Use VoronoiAlgorithm instead"))
+    bool bUseJumpFloodAlgorithm_DEPRECATED = true;
+
+    // Greedy meshing: fonde le facce superiori complanari (stesso territorio, stessa altezza) in rettangoli
+    // e le facce laterali in strisce. Silhouette identica, molti meno vertici se CellHeightRange è stretto.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Advanced")
+    bool bUseGreedyMeshing = true;
+
+    // Vertex welding: i vertici con stessa posizione e normale sono condivisi dentro ogni territorio (mesh indicizzata)
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Advanced")
-    bool bUseJumpFloodAlgorithm = true;
+    bool bWeldVertices = true;
+
+    // Cache su disco delle mappe generate (Saved/MapCache), chiave = seed + hash di questa config + versione generatore.
+    // Con una hit si salta tutta la generazione (rematch/reconnect con lo stesso seed).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Advanced")
+    bool bUseMapCache = true;
+
+    // Budget per frame (ms) del lavoro di generazione che resta sul game thread (spawn actor + upload mesh).
+    // Si processano territori finché il budget non è esaurito (almeno uno per frame).
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Advanced", meta = (ClampMin = "0.5", UIMin = "0.5", UIMax = "16.0"))
+    float GenerationFrameBudgetMs = 4.0f;
 };
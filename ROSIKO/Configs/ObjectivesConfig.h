@@ -67,7 +67,7 @@ struct FObjectiveCondition
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition", meta = (ClampMin = "1"))
 	int32 RequiredCount = 1;
 
-	// Turno minimo richiesto (per SurviveUntilTurn)
+	// Giro minimo richiesto, vedi ARosikoGameState::CurrentRound (per SurviveUntilTurn)
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Condition",
 	          meta = (EditCondition = "Type == EObjectiveConditionType::SurviveUntilTurn", ClampMin = "1"))
 	int32 RequiredTurn = 1;
@@ -154,7 +154,7 @@ struct FAssignedObjective
 	UPROPERTY(BlueprintReadOnly, Category = "Objective")
 	bool bCompleted = false;
 
-	// Turno in cui l'obiettivo è stato completato (-1 se non ancora completato)
+	// Giro (ARosikoGameState::CurrentRound) in cui l'obiettivo è stato completato (-1 se non ancora completato)
 	UPROPERTY(BlueprintReadOnly, Category = "Objective")
 	int32 CompletionTurn = -1;
 
@@ -165,6 +165,14 @@ struct FAssignedObjective
 	// Timestamp di completamento (GameTimeSeconds)
 	UPROPERTY(BlueprintReadOnly, Category = "Objective")
 	float CompletionTimeSeconds = -1.0f;
+
+	// Progresso corrente per ogni condizione (stesso ordine di Definition.Conditions), aggiornato dal server
+	UPROPERTY(BlueprintReadOnly, Category = "Objective")
+	TArray<int32> ConditionProgress;
+
+	// Valore richiesto per ogni condizione (per barre di progresso in UI)
+	UPROPERTY(BlueprintReadOnly, Category = "Objective")
+	TArray<int32> ConditionTargets;
 };
 
 /**
@@ -0,0 +1,343 @@
+#include "ObjectiveTracker.h"
+#include "RosikoGameState.h"
+#include "RosikoPlayerState.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRosikoObjectiveTracker, Log, All);
+
+void FObjectiveTracker::Reset(const ARosikoGameState* InGameState)
+{
+	GameState = InGameState;
+
+	Conditions.Empty();
+	Objectives.Empty();
+	ObjectiveLookup.Empty();
+	TerritoryCountSubscribers.Empty();
+	ContinentSubscribers.Empty();
+	CardExchangeSubscribers.Empty();
+	EliminationSubscribers.Empty();
+	TurnSubscribers.Empty();
+	DirtyObjectives.Empty();
+}
+
+void FObjectiveTracker::AddObjective(int32 PlayerID, int32 Slot, const FObjectiveDefinition& Definition)
+{
+	const int32 ObjectiveIndex = Objectives.Num();
+	FObjectiveState& Objective = Objectives.AddDefaulted_GetRef();
+	Objective.PlayerID = PlayerID;
+	Objective.Slot = Slot;
+	Objective.FirstCondition = Conditions.Num();
+	Objective.NumConditions = Definition.Conditions.Num();
+	ObjectiveLookup.Add(MakeKey(PlayerID, Slot), ObjectiveIndex);
+
+	for (const FObjectiveCondition& Condition : Definition.Conditions)
+	{
+		const int32 ConditionIndex = Conditions.Num();
+		FConditionState& State = Conditions.AddDefaulted_GetRef();
+		State.Condition = Condition;
+		State.PlayerID = PlayerID;
+		State.ObjectiveIndex = ObjectiveIndex;
+
+		// Valore di progresso richiesto (mostrato in UI accanto al progresso)
+		switch (Condition.Type)
+		{
+			case EObjectiveConditionType::SurviveUntilTurn:
+				State.Target = Condition.RequiredTurn;
+				break;
+			case EObjectiveConditionType::EliminatePlayerColor:
+				State.Target = 1;
+				break;
+			default:
+				State.Target = Condition.RequiredCount;
+				break;
+		}
+
+		// Iscrizione agli eventi che possono cambiare questa condizione
+		switch (Condition.Type)
+		{
+			case EObjectiveConditionType::ConquerTerritories:
+			case EObjectiveConditionType::ControlAdjacentTerritories:
+				TerritoryCountSubscribers.FindOrAdd(PlayerID).Add(ConditionIndex);
+				break;
+
+			case EObjectiveConditionType::ConquerContinents:
+			case EObjectiveConditionType::ConquerTerritoriesInContinents:
+			case EObjectiveConditionType::ControlFullContinent:
+				for (int32 ContinentID : Condition.TargetContinentIDs)
+				{
+					ContinentSubscribers.FindOrAdd(MakeKey(PlayerID, ContinentID)).AddUnique(ConditionIndex);
+				}
+				break;
+
+			case EObjectiveConditionType::EliminatePlayerColor:
+				EliminationSubscribers.Add(ConditionIndex);
+				break;
+
+			case EObjectiveConditionType::SurviveUntilTurn:
+				// Dipende da turno, territori posseduti e dall'essere ancora in gioco
+				TerritoryCountSubscribers.FindOrAdd(PlayerID).Add(ConditionIndex);
+				TurnSubscribers.Add(ConditionIndex);
+				break;
+
+			case EObjectiveConditionType::ExchangeCardSets:
+				CardExchangeSubscribers.FindOrAdd(PlayerID).Add(ConditionIndex);
+				break;
+
+			case EObjectiveConditionType::Custom:
+			default:
+				UE_LOG(LogRosikoObjectiveTracker, Warning, TEXT("Player %d - objective condition type %d has no evaluator, it will never complete"),
+				       PlayerID, (int32)Condition.Type);
+				break;
+		}
+
+		// Stato iniziale
+		EvaluateCondition(State, State.Progress, State.bSatisfied);
+		if (!State.bSatisfied)
+		{
+			Objective.NumUnsatisfied++;
+		}
+	}
+
+	Objective.bDirty = true;
+	DirtyObjectives.Add(ObjectiveIndex);
+}
+
+// === EVENTI ===
+
+void FObjectiveTracker::NotifyTerritoryOwnerChanged(int32 TerritoryID, int32 OldOwnerID, int32 NewOwnerID)
+{
+	const ARosikoGameState* GS = GameState.Get();
+	const int32 ContinentID = GS ? GS->GetTerritoryContinent(TerritoryID) : INDEX_NONE;
+
+	for (int32 PlayerID : { OldOwnerID, NewOwnerID })
+	{
+		if (PlayerID < 0) continue;
+
+		RefreshConditions(TerritoryCountSubscribers.Find(PlayerID));
+		if (ContinentID != INDEX_NONE)
+		{
+			RefreshConditions(ContinentSubscribers.Find(MakeKey(PlayerID, ContinentID)));
+		}
+	}
+}
+
+void FObjectiveTracker::NotifyPlayerEliminated(int32 PlayerID)
+{
+	RefreshConditions(&EliminationSubscribers);
+	RefreshConditions(TerritoryCountSubscribers.Find(PlayerID));
+}
+
+void FObjectiveTracker::NotifyCardSetExchanged(int32 PlayerID)
+{
+	RefreshConditions(CardExchangeSubscribers.Find(PlayerID));
+}
+
+void FObjectiveTracker::NotifyTurnChanged()
+{
+	RefreshConditions(&TurnSubscribers);
+}
+
+// === QUERY ===
+
+bool FObjectiveTracker::IsObjectiveSatisfied(int32 PlayerID, int32 Slot) const
+{
+	const int32* ObjectiveIndex = ObjectiveLookup.Find(MakeKey(PlayerID, Slot));
+	return ObjectiveIndex && Objectives[*ObjectiveIndex].NumUnsatisfied == 0;
+}
+
+bool FObjectiveTracker::GetObjectiveProgress(int32 PlayerID, int32 Slot, TArray<int32>& OutProgress, TArray<int32>& OutTargets) const
+{
+	OutProgress.Reset();
+	OutTargets.Reset();
+
+	const int32* ObjectiveIndex = ObjectiveLookup.Find(MakeKey(PlayerID, Slot));
+	if (!ObjectiveIndex)
+	{
+		return false;
+	}
+
+	const FObjectiveState& Objective = Objectives[*ObjectiveIndex];
+	for (int32 i = 0; i < Objective.NumConditions; i++)
+	{
+		const FConditionState& State = Conditions[Objective.FirstCondition + i];
+		OutProgress.Add(State.Progress);
+		OutTargets.Add(State.Target);
+	}
+	return true;
+}
+
+TArray<TPair<int32, int32>> FObjectiveTracker::ConsumeDirtyObjectives()
+{
+	TArray<TPair<int32, int32>> Result;
+	Result.Reserve(DirtyObjectives.Num());
+
+	for (int32 ObjectiveIndex : DirtyObjectives)
+	{
+		FObjectiveState& Objective = Objectives[ObjectiveIndex];
+		Objective.bDirty = false;
+		Result.Emplace(Objective.PlayerID, Objective.Slot);
+	}
+	DirtyObjectives.Reset();
+
+	return Result;
+}
+
+// === INTERNAL ===
+
+void FObjectiveTracker::RefreshConditions(const TArray<int32>* ConditionIndices)
+{
+	if (!ConditionIndices)
+	{
+		return;
+	}
+
+	for (int32 ConditionIndex : *ConditionIndices)
+	{
+		FConditionState& State = Conditions[ConditionIndex];
+
+		int32 NewProgress = 0;
+		bool bNewSatisfied = false;
+		EvaluateCondition(State, NewProgress, bNewSatisfied);
+
+		if (NewProgress == State.Progress && bNewSatisfied == State.bSatisfied)
+		{
+			continue;
+		}
+
+		FObjectiveState& Objective = Objectives[State.ObjectiveIndex];
+		if (bNewSatisfied != State.bSatisfied)
+		{
+			Objective.NumUnsatisfied += bNewSatisfied ? -1 : 1;
+		}
+
+		State.Progress = NewProgress;
+		State.bSatisfied = bNewSatisfied;
+
+		if (!Objective.bDirty)
+		{
+			Objective.bDirty = true;
+			DirtyObjectives.Add(State.ObjectiveIndex);
+		}
+	}
+}
+
+void FObjectiveTracker::EvaluateCondition(const FConditionState& State, int32& OutProgress, bool& bOutSatisfied) const
+{
+	const FObjectiveCondition& Condition = State.Condition;
+	const ARosikoGameState* GS = GameState.Get();
+	const ARosikoPlayerState* PS = FindPlayerState(State.PlayerID);
+
+	OutProgress = 0;
+	bOutSatisfied = false;
+
+	if (!GS || !PS)
+	{
+		return;
+	}
+
+	switch (Condition.Type)
+	{
+		case EObjectiveConditionType::ConquerTerritories:
+		{
+			OutProgress = PS->GetNumTerritoriesOwned();
+			bOutSatisfied = OutProgress >= Condition.RequiredCount;
+			break;
+		}
+
+		case EObjectiveConditionType::ConquerContinents:
+		case EObjectiveConditionType::ControlFullContinent:
+		{
+			// Continenti target controllati completamente
+			for (int32 ContinentID : Condition.TargetContinentIDs)
+			{
+				if (GS->DoesPlayerControlContinent(State.PlayerID, ContinentID))
+				{
+					OutProgress++;
+				}
+			}
+			bOutSatisfied = OutProgress >= Condition.RequiredCount;
+			break;
+		}
+
+		case EObjectiveConditionType::ConquerTerritoriesInContinents:
+		{
+			for (int32 ContinentID : Condition.TargetContinentIDs)
+			{
+				OutProgress += GS->GetOwnedTerritoriesInContinent(State.PlayerID, ContinentID);
+			}
+			bOutSatisfied = OutProgress >= Condition.RequiredCount;
+			break;
+		}
+
+		case EObjectiveConditionType::EliminatePlayerColor:
+		{
+			// Il giocatore ha eliminato un giocatore con uno dei colori target
+			for (APlayerState* OtherBase : GS->PlayerArray)
+			{
+				const ARosikoPlayerState* OtherPS = Cast<ARosikoPlayerState>(OtherBase);
+				if (!OtherPS || OtherPS->GameManagerPlayerID == State.PlayerID || OtherPS->bIsAlive || OtherPS->EliminatedBy != State.PlayerID)
+				{
+					continue;
+				}
+
+				for (const FLinearColor& TargetColor : Condition.TargetColors)
+				{
+					if (OtherPS->ArmyColor.Equals(TargetColor, 0.01f))
+					{
+						OutProgress = 1;
+					}
+				}
+			}
+			bOutSatisfied = OutProgress >= 1;
+			break;
+		}
+
+		case EObjectiveConditionType::SurviveUntilTurn:
+		{
+			// Progresso = giro raggiunto; soddisfatta se ancora vivo e con abbastanza territori
+			OutProgress = FMath::Min(GS->CurrentRound, Condition.RequiredTurn);
+			bOutSatisfied = PS->bIsAlive &&
+			                GS->CurrentRound >= Condition.RequiredTurn &&
+			                PS->GetNumTerritoriesOwned() >= Condition.MinTerritories;
+			break;
+		}
+
+		case EObjectiveConditionType::ExchangeCardSets:
+		{
+			OutProgress = PS->CardExchangeCount;
+			bOutSatisfied = OutProgress >= Condition.RequiredCount;
+			break;
+		}
+
+		case EObjectiveConditionType::ControlAdjacentTerritories:
+		{
+			// Regione contigua più grande (union-find nel GameState)
+			OutProgress = GS->GetLargestOwnedRegion(State.PlayerID);
+			bOutSatisfied = OutProgress >= Condition.RequiredCount;
+			break;
+		}
+
+		case EObjectiveConditionType::Custom:
+		default:
+			// Nessun valutatore: mai soddisfatta
+			break;
+	}
+}
+
+const ARosikoPlayerState* FObjectiveTracker::FindPlayerState(int32 PlayerID) const
+{
+	const ARosikoGameState* GS = GameState.Get();
+	if (!GS)
+	{
+		return nullptr;
+	}
+
+	for (APlayerState* PS : GS->PlayerArray)
+	{
+		const ARosikoPlayerState* RPS = Cast<ARosikoPlayerState>(PS);
+		if (RPS && RPS->GameManagerPlayerID == PlayerID)
+		{
+			return RPS;
+		}
+	}
+	return nullptr;
+}
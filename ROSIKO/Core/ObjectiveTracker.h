@@ -0,0 +1,100 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "../Configs/ObjectivesConfig.h"
+
+class ARosikoGameState;
+class ARosikoPlayerState;
+
+/**
+ * Valutazione incrementale degli obiettivi (solo server, posseduto da ARosikoGameManager).
+ *
+ * Ogni FObjectiveCondition assegnata viene compilata in un valutatore con contatore di progresso,
+ * iscritto solo agli eventi che possono cambiarlo:
+ * - cambio proprietario territorio (per player, e per player x continente)
+ * - eliminazione di un giocatore
+ * - scambio tris di carte
+ * - cambio turno
+ *
+ * Un evento ricalcola solo i valutatori iscritti (query O(1) sui contatori del GameState) e marca
+ * sporchi solo gli obiettivi il cui progresso è cambiato. Ogni obiettivo tiene il numero di condizioni
+ * ancora non soddisfatte, quindi il check di completamento è O(1).
+ */
+class ROSIKO_API FObjectiveTracker
+{
+public:
+	// Slot dell'obiettivo principale (gli slot 0..N-1 sono gli obiettivi secondari)
+	static constexpr int32 MainObjectiveSlot = -1;
+
+	// Svuota tutto e collega il GameState usato per le query
+	void Reset(const ARosikoGameState* InGameState);
+
+	// Compila le condizioni di un obiettivo assegnato e ne calcola il progresso iniziale
+	void AddObjective(int32 PlayerID, int32 Slot, const FObjectiveDefinition& Definition);
+
+	// === EVENTI ===
+
+	void NotifyTerritoryOwnerChanged(int32 TerritoryID, int32 OldOwnerID, int32 NewOwnerID);
+	void NotifyPlayerEliminated(int32 PlayerID);
+	void NotifyCardSetExchanged(int32 PlayerID);
+	void NotifyTurnChanged();
+
+	// === QUERY ===
+
+	// Tutte le condizioni dell'obiettivo sono soddisfatte (O(1))
+	bool IsObjectiveSatisfied(int32 PlayerID, int32 Slot) const;
+
+	// Progresso corrente e valore richiesto per ogni condizione dell'obiettivo (stesso ordine di Definition.Conditions)
+	bool GetObjectiveProgress(int32 PlayerID, int32 Slot, TArray<int32>& OutProgress, TArray<int32>& OutTargets) const;
+
+	// Obiettivi il cui progresso è cambiato dall'ultima chiamata, come coppie (PlayerID, Slot)
+	TArray<TPair<int32, int32>> ConsumeDirtyObjectives();
+
+private:
+	struct FConditionState
+	{
+		FObjectiveCondition Condition;
+		int32 PlayerID = -1;
+		int32 ObjectiveIndex = INDEX_NONE;
+		int32 Progress = 0;
+		int32 Target = 1;
+		bool bSatisfied = false;
+	};
+
+	struct FObjectiveState
+	{
+		int32 PlayerID = -1;
+		int32 Slot = MainObjectiveSlot;
+		int32 FirstCondition = 0;
+		int32 NumConditions = 0;
+		int32 NumUnsatisfied = 0;
+		bool bDirty = false;
+	};
+
+	// Ricalcola progresso/soddisfazione di una condizione dallo stato autoritativo
+	void EvaluateCondition(const FConditionState& State, int32& OutProgress, bool& bOutSatisfied) const;
+
+	// Rivaluta le condizioni indicate e aggiorna contatori + dirty degli obiettivi coinvolti
+	void RefreshConditions(const TArray<int32>* ConditionIndices);
+
+	const ARosikoPlayerState* FindPlayerState(int32 PlayerID) const;
+
+	static uint64 MakeKey(int32 A, int32 B) { return ((uint64)(uint32)A << 32) | (uint32)B; }
+
+	TWeakObjectPtr<const ARosikoGameState> GameState;
+
+	TArray<FConditionState> Conditions;
+	TArray<FObjectiveState> Objectives;
+
+	// (PlayerID, Slot) -> indice in Objectives
+	TMap<uint64, int32> ObjectiveLookup;
+
+	// Iscrizioni: indici in Conditions
+	TMap<int32, TArray<int32>> TerritoryCountSubscribers; // PlayerID -> condizioni sul totale territori
+	TMap<uint64, TArray<int32>> ContinentSubscribers;     // (PlayerID, ContinentID) -> condizioni sul continente
+	TMap<int32, TArray<int32>> CardExchangeSubscribers;   // PlayerID -> condizioni sugli scambi carte
+	TArray<int32> EliminationSubscribers;                 // Condizioni su eliminazioni (qualsiasi player)
+	TArray<int32> TurnSubscribers;                        // Condizioni sul turno corrente
+
+	TArray<int32> DirtyObjectives;
+};
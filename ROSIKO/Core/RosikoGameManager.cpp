@@ -1,8 +1,10 @@
 #include "RosikoGameManager.h"
+#include "../ROSIKO.h"
 #include "RosikoGameState.h"
 #include "RosikoPlayerState.h"
 #include "../Map/MapGenerator.h"
 #include "../Map/Territory/TerritoryActor.h"
+#include "../Map/Territory/TerritoryRegistrySubsystem.h"
 #include "../Troop/UI/TroopDisplayComponent.h"
 #include "../Troop/UI/TroopVisualManager.h"
 #include "../Configs/ObjectivesConfig.h"
@@ -13,6 +15,16 @@
 // Log category
 DEFINE_LOG_CATEGORY_STATIC(LogRosikoGameManager, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("GameManager Territory Update"), STAT_RosikoTerritoryUpdate, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Territory Multicast"), STAT_RosikoTerritoryMulticast, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Refresh All Territories"), STAT_RosikoRefreshAllTerritories, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Player Update"), STAT_RosikoPlayerUpdate, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Phase/Turn Change"), STAT_RosikoPhaseTurnChange, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Distribute Territories"), STAT_RosikoDistributeTerritories, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Place Troops"), STAT_RosikoPlaceTroops, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Check Objectives"), STAT_RosikoCheckObjectives, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("GameManager Combat"), STAT_RosikoCombat, STATGROUP_Rosiko);
+
 ARosikoGameManager::ARosikoGameManager()
 {
 	PrimaryActorTick.bCanEverTick = false;
@@ -47,50 +59,19 @@ void ARosikoGameManager::Multicast_NotifyColorSelectionTurn_Implementation(int32
 	}
 }
 
-void ARosikoGameManager::Multicast_NotifyTerritoryUpdate_Implementation(int32 TerritoryID, int32 OwnerID, int32 TroopCount)
+void ARosikoGameManager::BeginPlay()
 {
-	// Eseguito su TUTTI i client (e server)
-	// Trova TerritoryActor e aggiorna visual localmente
-	ARosikoGameState* GS = GetRosikoGameState();
-	if (!GS) return;
+	Super::BeginPlay();
 
-	for (TActorIterator<ATerritoryActor> It(GetWorld()); It; ++It)
+	// Client: i territori replicati prima di questo actor sono rimasti in coda nel GameState.
+	// Se il GameState arriva dopo, lo troverà HandleTerritoryReplicated
+	if (!HasAuthority())
 	{
-		if (It->GetTerritoryData().ID == TerritoryID)
+		if (ARosikoGameState* GS = GetWorld() ? GetWorld()->GetGameState<ARosikoGameState>() : nullptr)
 		{
-			FLinearColor OwnerColor = FLinearColor::Gray;
-
-			if (OwnerID >= 0)
-			{
-				ARosikoPlayerState* PS = GetRosikoPlayerState(OwnerID);
-				if (PS)
-				{
-					OwnerColor = PS->ArmyColor;
-				}
-			}
-
-			// Aggiorna visual con nuovo sistema
-			if (It->TroopVisualManager)
-			{
-				It->TroopVisualManager->UpdateTroopDisplay(TroopCount, OwnerColor);
-			}
-			// Fallback a legacy
-			else if (It->TroopDisplay)
-			{
-				It->TroopDisplay->UpdateDisplay(TroopCount, OwnerColor);
-				It->TroopDisplay->SetDisplayVisible(TroopCount > 0);
-			}
-
-			UE_LOG(LogRosikoGameManager, Verbose, TEXT("Multicast update Territory %d: Owner=%d, Troops=%d"),
-			       TerritoryID, OwnerID, TroopCount);
-			break;
+			GS->RegisterGameManager(this);
 		}
 	}
-}
-
-void ARosikoGameManager::BeginPlay()
-{
-	Super::BeginPlay();
 
 	// NOTE: Non chiamiamo StartGame() automaticamente qui.
 	// StartGame() deve essere chiamato DOPO che MapGenerator ha generato la mappa.
@@ -106,6 +87,15 @@ void ARosikoGameManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
 		UE_LOG(LogRosikoGameManager, Log, TEXT("Game time update timer cleared"));
 	}
 
+	// Update territori ancora in coda: il flush del prossimo tick non arriverà
+	if (GetWorld())
+	{
+		GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+	}
+	bTerritoryFlushPending = false;
+	DirtyTerritoryIDs.Empty();
+	DirtyTerritoryMask.Empty();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -213,6 +203,13 @@ void ARosikoGameManager::StartGame()
 	// 3. Inizializza RNG con stesso seed del MapGenerator (per determinismo)
 	GameRNG.Initialize(MapGenerator->MapSeed + 1000); // +1000 per evitare overlap con generazione mappa
 
+	// Dadi: seed solo server. Derivarlo dal MapSeed replicato renderebbe i tiri prevedibili dai client
+	const uint64 CombatEntropy = FPlatformTime::Cycles64() ^ ((uint64)FMath::Rand() << 32);
+	const int32 CombatSeed = (int32)(CombatEntropy ^ (CombatEntropy >> 32));
+	CombatRNG.Initialize(CombatSeed);
+	CombatSequence = 0;
+	UE_LOG(LogRosikoGameManager, Log, TEXT("Combat RNG seed: %d"), CombatSeed);
+
 	// 4. Inizializza componenti gioco
 	InitializePlayers();
 	InitializeTerritories();
@@ -251,6 +248,7 @@ void ARosikoGameManager::InitializePlayers()
 		PS->bIsAlive = true;
 		PS->bIsAI = false; // TODO: Implementare AI in futuro
 		PS->CardExchangeCount = 0;
+		ObjectiveTracker.NotifyCardSetExchanged(PS->GameManagerPlayerID);
 		PS->bHasSelectedColor = false;
 		PS->ArmyColor = FLinearColor::White; // Placeholder - verrà scelto in fase ColorSelection
 
@@ -274,7 +272,7 @@ void ARosikoGameManager::InitializeTerritories()
 		return;
 	}
 
-	GS->Territories.Empty();
+	GS->Territories.Items.Empty();
 
 	const TArray<FGeneratedTerritory>& GenTerritories = MapGenerator->GetGeneratedTerritories();
 
@@ -282,15 +280,25 @@ void ARosikoGameManager::InitializeTerritories()
 	{
 		if (GenTerritory.bIsOcean) continue; // Salta oceani
 
-		FTerritoryGameState NewState;
+		FTerritoryGameState& NewState = GS->Territories.Items.AddDefaulted_GetRef();
 		NewState.TerritoryID = GenTerritory.ID;
 		NewState.OwnerID = -1; // Neutrale inizialmente
 		NewState.Troops = 0;
 
-		GS->Territories.Add(NewState);
+		GS->Territories.MarkItemDirty(NewState);
 	}
+	GS->Territories.MarkArrayDirty();
+
+	// Contatori [player x continente] per le query di controllo continenti
+	GS->InitializeContinentOwnership(GenTerritories, NumPlayers);
 
-	UE_LOG(LogRosikoGameManager, Log, TEXT("Initialized %d territories"), GS->Territories.Num());
+	// Regioni contigue per gli obiettivi ControlAdjacentTerritories
+	GS->InitializeTerritoryRegions(*MapGenerator);
+
+	// Lookup per ID in O(1) lato server (i client ricostruiscono nel callback di replicazione)
+	GS->RebuildTerritoryIndex();
+
+	UE_LOG(LogRosikoGameManager, Log, TEXT("Initialized %d territories"), GS->Territories.Items.Num());
 }
 
 void ARosikoGameManager::InitializeTurnOrder()
@@ -303,6 +311,7 @@ void ARosikoGameManager::InitializeTurnOrder()
 	}
 
 	GS->TurnOrder.Empty();
+	GS->CurrentRound = 0;
 
 	// Crea array sequenziale di PlayerID
 	for (int32 i = 0; i < NumPlayers; i++)
@@ -335,7 +344,7 @@ void ARosikoGameManager::InitializeCardDeck()
 
 	// Ottieni lista territori validi (escludi oceani)
 	TArray<int32> TerritoryIDs;
-	for (const FTerritoryGameState& Territory : GS->Territories)
+	for (const FTerritoryGameState& Territory : GS->Territories.Items)
 	{
 		TerritoryIDs.Add(Territory.TerritoryID);
 	}
@@ -398,6 +407,8 @@ void ARosikoGameManager::InitializeCardDeck()
 
 void ARosikoGameManager::DistributeInitialTerritories()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoDistributeTerritories);
+
 	ARosikoGameState* GS = GetRosikoGameState();
 	if (!GS)
 	{
@@ -407,7 +418,7 @@ void ARosikoGameManager::DistributeInitialTerritories()
 
 	// Crea lista territori disponibili
 	TArray<int32> AvailableTerritoryIDs;
-	for (const FTerritoryGameState& Territory : GS->Territories)
+	for (const FTerritoryGameState& Territory : GS->Territories.Items)
 	{
 		AvailableTerritoryIDs.Add(Territory.TerritoryID);
 	}
@@ -431,10 +442,9 @@ void ARosikoGameManager::DistributeInitialTerritories()
 		FTerritoryGameState* Territory = GS->GetTerritory(TerritoryID);
 		if (!Territory) continue;
 
-		Territory->OwnerID = PlayerID;
+		SetTerritoryOwner(TerritoryID, PlayerID);
 		Territory->Troops = 1; // Piazza 1 carro iniziale per "reclamare" il territorio
 
-		PS->AddTerritory(TerritoryID);
 		PS->RemoveTroops(1); // Consuma 1 carro
 
 		BroadcastTerritoryUpdate(TerritoryID);
@@ -713,6 +723,8 @@ void ARosikoGameManager::SelectPlayerColor_Direct(int32 PlayerID, FLinearColor C
 
 bool ARosikoGameManager::PlaceTroops(int32 PlayerID, int32 TerritoryID, int32 Amount)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoPlaceTroops);
+
 	// Validazione base
 	if (Amount <= 0)
 	{
@@ -822,12 +834,18 @@ void ARosikoGameManager::EndTurn()
 		// Tutti hanno piazzato tutti i carri → Fine fase iniziale
 		UE_LOG(LogRosikoGameManager, Log, TEXT("Initial placement complete! Starting main game."));
 		ChangePhase(EGamePhase::Reinforce);
+		GS->CurrentRound = 1;
 		ChangeTurn(0); // Ricomincia dal primo in TurnOrder
 	}
 	else
 	{
 		// Turno normale (Reinforce/Attack/Fortify cycle)
 		int32 NextTurnIndex = (GS->CurrentPlayerTurn + 1) % GS->TurnOrder.Num();
+		if (NextTurnIndex == 0)
+		{
+			// TurnOrder ricomincia: nuovo giro (prima di ChangeTurn, che rivaluta SurviveUntilTurn)
+			GS->CurrentRound++;
+		}
 		ChangeTurn(NextTurnIndex);
 
 		// TODO: Se siamo in fase Attack, permetti di continuare attacchi o passare a Fortify
@@ -936,99 +954,367 @@ bool ARosikoGameManager::CanPlaceTroops(int32 PlayerID, int32 TerritoryID) const
 	return (Territory->OwnerID == PlayerID) && (PS->TroopsToPlace > 0);
 }
 
-void ARosikoGameManager::BroadcastTerritoryUpdate(int32 TerritoryID)
+bool ARosikoGameManager::Attack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 NumAttackDice)
+{
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoCombat);
+
+	FTerritoryGameState* From = nullptr;
+	FTerritoryGameState* To = nullptr;
+	if (!ValidateAttack(PlayerID, FromTerritoryID, ToTerritoryID, From, To))
+	{
+		return false;
+	}
+
+	if (NumAttackDice <= 0)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - invalid dice count: %d"), NumAttackDice);
+		return false;
+	}
+
+	FCombatResult Result;
+	Result.AttackerID = PlayerID;
+	Result.DefenderID = To->OwnerID;
+	Result.FromTerritoryID = FromTerritoryID;
+	Result.ToTerritoryID = ToTerritoryID;
+	Result.bBlitz = false;
+
+	RollCombatRound(NumAttackDice, *From, *To, Result);
+	FinishCombat(*From, *To, Result);
+	return true;
+}
+
+bool ARosikoGameManager::BlitzAttack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 StopAtTroops)
+{
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoCombat);
+
+	FTerritoryGameState* From = nullptr;
+	FTerritoryGameState* To = nullptr;
+	if (!ValidateAttack(PlayerID, FromTerritoryID, ToTerritoryID, From, To))
+	{
+		return false;
+	}
+
+	// Serve almeno un carro oltre al minimo per poter attaccare
+	const int32 StopAt = FMath::Max(StopAtTroops, GameRules->MinTroopsRemaining);
+	if (From->Troops <= StopAt)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("BlitzAttack - territory %d already at stop threshold (%d troops, stop at %d)"),
+		       FromTerritoryID, From->Troops, StopAt);
+		return false;
+	}
+
+	FCombatResult Result;
+	Result.AttackerID = PlayerID;
+	Result.DefenderID = To->OwnerID;
+	Result.FromTerritoryID = FromTerritoryID;
+	Result.ToTerritoryID = ToTerritoryID;
+	Result.bBlitz = true;
+
+	// Tutta la sequenza in locale: nessuna replicazione/evento finché non termina
+	while (From->Troops > StopAt && To->Troops > 0)
+	{
+		const int32 LossesBefore = Result.AttackerLosses + Result.DefenderLosses;
+		RollCombatRound(GameRules->MaxAttackDice, *From, *To, Result);
+
+		// Nessuna perdita = regole non valide (es. 0 dadi): il loop non terminerebbe mai
+		if (Result.AttackerLosses + Result.DefenderLosses == LossesBefore)
+		{
+			UE_LOG(LogRosikoGameManager, Error, TEXT("BlitzAttack - combat round produced no losses, check GameRules dice settings"));
+			break;
+		}
+	}
+
+	FinishCombat(*From, *To, Result);
+	return true;
+}
+
+bool ARosikoGameManager::ValidateAttack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID,
+                                        FTerritoryGameState*& OutFrom, FTerritoryGameState*& OutTo) const
 {
+	OutFrom = nullptr;
+	OutTo = nullptr;
+
+	if (!HasAuthority())
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack called on client - ignoring"));
+		return false;
+	}
+
 	ARosikoGameState* GS = GetRosikoGameState();
-	if (!GS) return;
+	if (!GS || !GameRules || !MapGenerator)
+	{
+		UE_LOG(LogRosikoGameManager, Error, TEXT("Attack - GameState, GameRules or MapGenerator is null!"));
+		return false;
+	}
 
-	FTerritoryGameState* State = GS->GetTerritory(TerritoryID);
-	if (!State) return;
+	if (GS->CurrentPhase != EGamePhase::Attack || GS->GetCurrentPlayerID() != PlayerID)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - Player %d cannot attack now (phase %d)"),
+		       PlayerID, (int32)GS->CurrentPhase);
+		return false;
+	}
 
-	// Invia Multicast RPC per notificare tutti i client
-	if (HasAuthority())
+	FTerritoryGameState* From = GS->GetTerritory(FromTerritoryID);
+	FTerritoryGameState* To = GS->GetTerritory(ToTerritoryID);
+	if (!From || !To)
 	{
-		Multicast_NotifyTerritoryUpdate(TerritoryID, State->OwnerID, State->Troops);
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - invalid territories %d -> %d"), FromTerritoryID, ToTerritoryID);
+		return false;
 	}
 
-	// Trova TerritoryActor corrispondente e aggiorna visuals
-	bool bFoundTerritory = false;
-	for (TActorIterator<ATerritoryActor> It(GetWorld()); It; ++It)
+	if (From->OwnerID != PlayerID || To->OwnerID == PlayerID)
 	{
-		if (It->GetTerritoryData().ID == TerritoryID)
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - Player %d must own %d and not own %d"),
+		       PlayerID, FromTerritoryID, ToTerritoryID);
+		return false;
+	}
+
+	// Un bersaglio neutrale o senza carri non ha un difensore da affrontare
+	if (To->OwnerID < 0 || To->Troops <= 0)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - territory %d has no defender (owner %d, %d troops)"),
+		       ToTerritoryID, To->OwnerID, To->Troops);
+		return false;
+	}
+
+	if (!MapGenerator->AreTerritoriesAdjacent(FromTerritoryID, ToTerritoryID))
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - territories %d and %d are not adjacent"), FromTerritoryID, ToTerritoryID);
+		return false;
+	}
+
+	if (From->Troops <= GameRules->MinTroopsRemaining)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Attack - territory %d has only %d troops"), FromTerritoryID, From->Troops);
+		return false;
+	}
+
+	OutFrom = From;
+	OutTo = To;
+	return true;
+}
+
+void ARosikoGameManager::RollCombatRound(int32 NumAttackDice, FTerritoryGameState& From, FTerritoryGameState& To, FCombatResult& Result)
+{
+	const int32 AttackDiceCount = FMath::Clamp(NumAttackDice, 1, FMath::Min(GameRules->MaxAttackDice, From.Troops - GameRules->MinTroopsRemaining));
+	const int32 DefenseDiceCount = FMath::Clamp(To.Troops, 1, GameRules->MaxDefenseDice);
+
+	Result.AttackDice.SetNumUninitialized(AttackDiceCount);
+	Result.DefenseDice.SetNumUninitialized(DefenseDiceCount);
+	for (uint8& Die : Result.AttackDice)
+	{
+		Die = (uint8)CombatRNG.RandRange(1, 6);
+	}
+	for (uint8& Die : Result.DefenseDice)
+	{
+		Die = (uint8)CombatRNG.RandRange(1, 6);
+	}
+	Result.AttackDice.Sort(TGreater<uint8>());
+	Result.DefenseDice.Sort(TGreater<uint8>());
+
+	// Confronto a coppie, dal dado più alto
+	const int32 NumPairs = FMath::Min(AttackDiceCount, DefenseDiceCount);
+	int32 AttackerLosses = 0;
+	for (int32 i = 0; i < NumPairs; i++)
+	{
+		const bool bAttackerWins = GameRules->bAttackerWinsTies
+			? Result.AttackDice[i] >= Result.DefenseDice[i]
+			: Result.AttackDice[i] > Result.DefenseDice[i];
+		if (!bAttackerWins)
 		{
-			bFoundTerritory = true;
+			AttackerLosses++;
+		}
+	}
+	const int32 DefenderLosses = NumPairs - AttackerLosses;
 
-			// Aggiorna display carri con nuovo sistema LOD
-			if (It->TroopVisualManager)
-			{
-				FLinearColor OwnerColor = FLinearColor::Gray; // Default neutrale
+	From.Troops -= AttackerLosses;
+	To.Troops -= DefenderLosses;
 
-				if (State->OwnerID >= 0)
-				{
-					ARosikoPlayerState* PS = GetRosikoPlayerState(State->OwnerID);
-					if (PS)
-					{
-						OwnerColor = PS->ArmyColor;
-					}
-				}
+	Result.NumRolls++;
+	Result.AttackerLosses += AttackerLosses;
+	Result.DefenderLosses += DefenderLosses;
+}
 
-				It->TroopVisualManager->UpdateTroopDisplay(State->Troops, OwnerColor);
+void ARosikoGameManager::FinishCombat(FTerritoryGameState& From, FTerritoryGameState& To, FCombatResult& Result)
+{
+	ARosikoGameState* GS = GetRosikoGameState();
 
-				UE_LOG(LogRosikoGameManager, Verbose, TEXT("Updated Territory %d: Owner=%d, Troops=%d, Color=(%f,%f,%f)"),
-				       TerritoryID, State->OwnerID, State->Troops, OwnerColor.R, OwnerColor.G, OwnerColor.B);
-			}
-			// Fallback a sistema legacy se nuovo non disponibile
-			else if (It->TroopDisplay)
-			{
-				FLinearColor OwnerColor = FLinearColor::Gray;
+	if (To.Troops <= 0)
+	{
+		// Il difensore perde l'ultimo territorio: registra chi l'ha eliminato prima del cambio proprietario
+		ARosikoPlayerState* DefenderPS = GetRosikoPlayerState(Result.DefenderID);
+		if (DefenderPS && DefenderPS->GetNumTerritoriesOwned() == 1)
+		{
+			DefenderPS->EliminatedBy = Result.AttackerID;
+		}
 
-				if (State->OwnerID >= 0)
-				{
-					ARosikoPlayerState* PS = GetRosikoPlayerState(State->OwnerID);
-					if (PS)
-					{
-						OwnerColor = PS->ArmyColor;
-					}
-				}
+		SetTerritoryOwner(Result.ToTerritoryID, Result.AttackerID);
 
-				It->TroopDisplay->UpdateDisplay(State->Troops, OwnerColor);
-				It->TroopDisplay->SetDisplayVisible(State->Troops > 0);
+		// Si spostano almeno i dadi dell'ultimo lancio (sempre disponibili: AttackDice <= Troops - MinTroopsRemaining)
+		Result.TroopsMoved = Result.AttackDice.Num();
+		From.Troops -= Result.TroopsMoved;
+		To.Troops = Result.TroopsMoved;
+		Result.bConquered = true;
+	}
 
-				UE_LOG(LogRosikoGameManager, Verbose, TEXT("Updated Territory %d (legacy mode): Owner=%d, Troops=%d"),
-				       TerritoryID, State->OwnerID, State->Troops);
-			}
-			else
-			{
-				UE_LOG(LogRosikoGameManager, Warning, TEXT("Territory %d has no TroopVisualManager or TroopDisplay component!"), TerritoryID);
-			}
+	BroadcastTerritoryUpdate(Result.FromTerritoryID);
+	BroadcastTerritoryUpdate(Result.ToTerritoryID);
+	if (Result.bConquered)
+	{
+		BroadcastPlayerUpdate(Result.AttackerID);
+		BroadcastPlayerUpdate(Result.DefenderID);
+	}
 
-			break;
+	UE_LOG(LogRosikoGameManager, Log, TEXT("Combat %d -> %d (%s): %d rolls, attacker -%d, defender -%d%s"),
+	       Result.FromTerritoryID, Result.ToTerritoryID, Result.bBlitz ? TEXT("blitz") : TEXT("single"),
+	       Result.NumRolls, Result.AttackerLosses, Result.DefenderLosses, Result.bConquered ? TEXT(", CONQUERED") : TEXT(""));
+
+	// Un solo risultato replicato per comando
+	Result.CombatSequence = ++CombatSequence;
+	GS->LastCombatResult = Result;
+	OnCombatResolved.Broadcast(Result);
+}
+
+void ARosikoGameManager::BroadcastTerritoryUpdate(int32 TerritoryID)
+{
+	if (TerritoryID < 0) return;
+
+	// Server: solo l'elemento modificato viaggia verso i client (che aggiornano i visual nei callback di replicazione)
+	if (HasAuthority())
+	{
+		if (ARosikoGameState* GS = GetRosikoGameState())
+		{
+			GS->MarkTerritoryDirty(TerritoryID);
 		}
 	}
 
-	if (!bFoundTerritory)
+	// Accoda: più modifiche allo stesso territorio nello stesso frame producono un solo update
+	if (!DirtyTerritoryMask.IsValidIndex(TerritoryID))
+	{
+		DirtyTerritoryMask.SetNum(TerritoryID + 1, false);
+	}
+	if (!DirtyTerritoryMask[TerritoryID])
 	{
-		UE_LOG(LogRosikoGameManager, Warning, TEXT("BroadcastTerritoryUpdate: Territory %d actor not found!"), TerritoryID);
+		DirtyTerritoryMask[TerritoryID] = true;
+		DirtyTerritoryIDs.Add(TerritoryID);
 	}
 
-	// Broadcast evento per UI
-	OnTerritoryUpdated.Broadcast(TerritoryID);
+	// Flush al prossimo tick (una sola volta per frame)
+	if (!bTerritoryFlushPending && GetWorld())
+	{
+		bTerritoryFlushPending = true;
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ARosikoGameManager::FlushTerritoryUpdates);
+	}
+}
+
+void ARosikoGameManager::FlushTerritoryUpdates()
+{
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTerritoryUpdate);
+
+	bTerritoryFlushPending = false;
+
+	ARosikoGameState* GS = GetRosikoGameState();
+	if (!GS || DirtyTerritoryIDs.Num() == 0)
+	{
+		DirtyTerritoryIDs.Reset();
+		DirtyTerritoryMask.Init(false, DirtyTerritoryMask.Num());
+		return;
+	}
+
+	// Generazione solo logica (dedicated server): non ci sono TerritoryActor da aggiornare
+	const bool bHasVisuals = !(MapGenerator && MapGenerator->IsLogicOnlyGeneration());
+	UTerritoryRegistrySubsystem* Registry = bHasVisuals ? GetWorld()->GetSubsystem<UTerritoryRegistrySubsystem>() : nullptr;
+
+	// Stato finale di ogni territorio sporco (più modifiche nello stesso frame = un solo refresh)
+	TArray<int32> UpdatedIDs = MoveTemp(DirtyTerritoryIDs);
+	DirtyTerritoryIDs.Reset();
+	for (int32 TerritoryID : UpdatedIDs)
+	{
+		DirtyTerritoryMask[TerritoryID] = false;
+
+		const FTerritoryGameState* State = GS->GetTerritory(TerritoryID);
+		if (State && Registry)
+		{
+			UpdateTerritoryVisuals(Registry->FindTerritory(TerritoryID), *State);
+		}
+	}
+
+	// Eventi UI dopo aver aggiornato tutti i visual (un passaggio, già deduplicato)
+	for (int32 TerritoryID : UpdatedIDs)
+	{
+		OnTerritoryUpdated.Broadcast(TerritoryID);
+	}
+
+	// Progresso obiettivi per la UI (una volta per frame, solo obiettivi toccati)
+	if (HasAuthority())
+	{
+		SyncObjectiveProgress();
+	}
+
+	UE_LOG(LogRosikoGameManager, Verbose, TEXT("Territory update flush: %d territories"), UpdatedIDs.Num());
+}
+
+void ARosikoGameManager::UpdateTerritoryVisuals(ATerritoryActor* Territory, const FTerritoryGameState& State)
+{
+	if (!Territory)
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("UpdateTerritoryVisuals: Territory %d actor not found!"), State.TerritoryID);
+		return;
+	}
+
+	FLinearColor OwnerColor = FLinearColor::Gray; // Default neutrale
+
+	if (State.OwnerID >= 0)
+	{
+		ARosikoPlayerState* PS = GetRosikoPlayerState(State.OwnerID);
+		if (PS)
+		{
+			OwnerColor = PS->ArmyColor;
+		}
+	}
+
+	// Aggiorna display carri con nuovo sistema LOD
+	if (Territory->TroopVisualManager)
+	{
+		Territory->TroopVisualManager->UpdateTroopDisplay(State.Troops, OwnerColor);
+
+		UE_LOG(LogRosikoGameManager, Verbose, TEXT("Updated Territory %d: Owner=%d, Troops=%d, Color=(%f,%f,%f)"),
+		       State.TerritoryID, State.OwnerID, State.Troops, OwnerColor.R, OwnerColor.G, OwnerColor.B);
+	}
+	// Fallback a sistema legacy se nuovo non disponibile
+	else if (Territory->TroopDisplay)
+	{
+		Territory->TroopDisplay->UpdateDisplay(State.Troops, OwnerColor);
+		Territory->TroopDisplay->SetDisplayVisible(State.Troops > 0);
+
+		UE_LOG(LogRosikoGameManager, Verbose, TEXT("Updated Territory %d (legacy mode): Owner=%d, Troops=%d"),
+		       State.TerritoryID, State.OwnerID, State.Troops);
+	}
+	else
+	{
+		UE_LOG(LogRosikoGameManager, Warning, TEXT("Territory %d has no TroopVisualManager or TroopDisplay component!"), State.TerritoryID);
+	}
 }
 
 void ARosikoGameManager::BroadcastPlayerUpdate(int32 PlayerID)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoPlayerUpdate);
+
 	OnPlayerUpdated.Broadcast(PlayerID);
 }
 
 void ARosikoGameManager::RefreshAllTerritoryDisplays()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoRefreshAllTerritories);
+
 	ARosikoGameState* GS = GetRosikoGameState();
 	if (!GS) return;
 
+	// Accoda tutti i territori: si fondono con eventuali update già in coda in un unico multicast
 	UE_LOG(LogRosikoGameManager, Log, TEXT("Refreshing all territory displays..."));
 
 	int32 RefreshedCount = 0;
-	for (const FTerritoryGameState& Territory : GS->Territories)
+	for (const FTerritoryGameState& Territory : GS->Territories.Items)
 	{
 		BroadcastTerritoryUpdate(Territory.TerritoryID);
 		RefreshedCount++;
@@ -1039,6 +1325,8 @@ void ARosikoGameManager::RefreshAllTerritoryDisplays()
 
 void ARosikoGameManager::ChangePhase(EGamePhase NewPhase)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoPhaseTurnChange);
+
 	// Solo il server può cambiare fase
 	if (!HasAuthority())
 	{
@@ -1066,10 +1354,13 @@ void ARosikoGameManager::ChangePhase(EGamePhase NewPhase)
 
 void ARosikoGameManager::ChangeTurn(int32 NewTurnIndex)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoPhaseTurnChange);
+
 	ARosikoGameState* GS = GetRosikoGameState();
 	if (!GS) return;
 
 	GS->CurrentPlayerTurn = NewTurnIndex;
+	ObjectiveTracker.NotifyTurnChanged();
 
 	if (GS->TurnOrder.IsValidIndex(GS->CurrentPlayerTurn))
 	{
@@ -1129,6 +1420,8 @@ void ARosikoGameManager::AssignObjectivesToAllPlayers()
 	ARosikoGameState* GS = GetRosikoGameState();
 	if (!GS) return;
 
+	ObjectiveTracker.Reset(GS);
+
 	for (int32 PlayerID : GS->TurnOrder)
 	{
 		ARosikoPlayerState* PS = GetRosikoPlayerState(PlayerID);
@@ -1138,11 +1431,15 @@ void ARosikoGameManager::AssignObjectivesToAllPlayers()
 		}
 	}
 
+	SyncObjectiveProgress();
+
 	UE_LOG(LogRosikoGameManager, Warning, TEXT("Objectives assigned to all players successfully!"));
 }
 
 bool ARosikoGameManager::CheckPlayerObjectives(int32 PlayerID)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoCheckObjectives);
+
 	if (!HasAuthority())
 	{
 		return false; // Solo il server valuta obiettivi
@@ -1158,22 +1455,16 @@ bool ARosikoGameManager::CheckPlayerObjectives(int32 PlayerID)
 
 	bool bAnyObjectiveCompleted = false;
 
+	// I contatori sono già aggiornati dagli eventi: qui resta solo il turno (assegnato anche fuori da ChangeTurn)
+	ObjectiveTracker.NotifyTurnChanged();
+	SyncObjectiveProgress();
+
 	// Verifica obiettivo principale (se non già completato)
 	if (!PS->MainObjective.bCompleted && PS->MainObjective.ObjectiveIndex >= 0)
 	{
-		bool bAllConditionsMet = true;
-		for (const FObjectiveCondition& Condition : PS->MainObjective.Definition.Conditions)
-		{
-			if (!EvaluateObjectiveCondition(Condition, PS))
-			{
-				bAllConditionsMet = false;
-				break;
-			}
-		}
-
-		if (bAllConditionsMet)
+		if (ObjectiveTracker.IsObjectiveSatisfied(PlayerID, FObjectiveTracker::MainObjectiveSlot))
 		{
-			PS->CompleteMainObjective(GS->CurrentPlayerTurn, GS->GameTimeSeconds);
+			PS->CompleteMainObjective(GS->CurrentRound, GS->GameTimeSeconds);
 			bAnyObjectiveCompleted = true;
 
 			// TODO: Broadcast evento vittoria se obiettivo principale completato
@@ -1191,19 +1482,9 @@ bool ARosikoGameManager::CheckPlayerObjectives(int32 PlayerID)
 			continue; // Già completato, skip
 		}
 
-		bool bAllConditionsMet = true;
-		for (const FObjectiveCondition& Condition : SecondaryObj.Definition.Conditions)
+		if (ObjectiveTracker.IsObjectiveSatisfied(PlayerID, i))
 		{
-			if (!EvaluateObjectiveCondition(Condition, PS))
-			{
-				bAllConditionsMet = false;
-				break;
-			}
-		}
-
-		if (bAllConditionsMet)
-		{
-			PS->CompleteSecondaryObjective(i, GS->CurrentPlayerTurn, GS->GameTimeSeconds);
+			PS->CompleteSecondaryObjective(i, GS->CurrentRound, GS->GameTimeSeconds);
 			bAnyObjectiveCompleted = true;
 		}
 	}
@@ -1213,6 +1494,8 @@ bool ARosikoGameManager::CheckPlayerObjectives(int32 PlayerID)
 
 void ARosikoGameManager::CheckAllObjectivesCompletion()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoCheckObjectives);
+
 	if (!HasAuthority())
 	{
 		return;
@@ -1233,6 +1516,51 @@ void ARosikoGameManager::CheckAllObjectivesCompletion()
 
 // === OBIETTIVI - INTERNAL LOGIC ===
 
+void ARosikoGameManager::SyncObjectiveProgress()
+{
+	// Solo gli obiettivi toccati da un evento dall'ultima sincronizzazione
+	TArray<int32> Progress;
+	TArray<int32> Targets;
+	for (const TPair<int32, int32>& Dirty : ObjectiveTracker.ConsumeDirtyObjectives())
+	{
+		ARosikoPlayerState* PS = GetRosikoPlayerState(Dirty.Key);
+		if (PS && ObjectiveTracker.GetObjectiveProgress(Dirty.Key, Dirty.Value, Progress, Targets))
+		{
+			PS->SetObjectiveProgress(Dirty.Value, Progress, Targets);
+		}
+	}
+}
+
+void ARosikoGameManager::SetTerritoryOwner(int32 TerritoryID, int32 NewOwnerID)
+{
+	ARosikoGameState* GS = GetRosikoGameState();
+	const FTerritoryGameState* Territory = GS ? GS->GetTerritory(TerritoryID) : nullptr;
+	if (!Territory || Territory->OwnerID == NewOwnerID)
+	{
+		return;
+	}
+
+	const int32 OldOwnerID = Territory->OwnerID;
+	GS->SetTerritoryOwner(TerritoryID, NewOwnerID);
+
+	ARosikoPlayerState* OldPS = OldOwnerID >= 0 ? GetRosikoPlayerState(OldOwnerID) : nullptr;
+	const bool bWasAlive = OldPS && OldPS->bIsAlive;
+	if (OldPS)
+	{
+		OldPS->RemoveTerritory(TerritoryID);
+	}
+	if (ARosikoPlayerState* NewPS = NewOwnerID >= 0 ? GetRosikoPlayerState(NewOwnerID) : nullptr)
+	{
+		NewPS->AddTerritory(TerritoryID);
+	}
+
+	ObjectiveTracker.NotifyTerritoryOwnerChanged(TerritoryID, OldOwnerID, NewOwnerID);
+	if (bWasAlive && !OldPS->bIsAlive)
+	{
+		ObjectiveTracker.NotifyPlayerEliminated(OldOwnerID);
+	}
+}
+
 void ARosikoGameManager::FilterAndShuffleObjectives()
 {
 	ARosikoGameState* GS = GetRosikoGameState();
@@ -1298,6 +1626,7 @@ void ARosikoGameManager::AssignObjectivesToPlayer(ARosikoPlayerState* PS)
 			: FMath::Min(PlayerID, ValidMainObjectives.Num() - 1);
 
 		PS->AssignMainObjective(ValidMainObjectives[MainIndex], MainIndex);
+		ObjectiveTracker.AddObjective(PlayerID, FObjectiveTracker::MainObjectiveSlot, ValidMainObjectives[MainIndex]);
 	}
 	else
 	{
@@ -1344,200 +1673,10 @@ void ARosikoGameManager::AssignObjectivesToPlayer(ARosikoPlayerState* PS)
 			}
 
 			PS->AssignSecondaryObjective(ValidSecondaryObjectives[SecondaryIndex], SecondaryIndex);
+			ObjectiveTracker.AddObjective(PlayerID, PS->SecondaryObjectives.Num() - 1, ValidSecondaryObjectives[SecondaryIndex]);
 		}
 	}
 
 	UE_LOG(LogRosikoGameManager, Log, TEXT("Player %d - Assigned 1 main + %d secondary objectives"),
 	       PlayerID, PS->SecondaryObjectives.Num());
 }
-
-bool ARosikoGameManager::EvaluateObjectiveCondition(const FObjectiveCondition& Condition, ARosikoPlayerState* PS)
-{
-	if (!PS)
-	{
-		return false;
-	}
-
-	ARosikoGameState* GS = GetRosikoGameState();
-	if (!GS)
-	{
-		return false;
-	}
-
-	int32 PlayerID = PS->GameManagerPlayerID;
-
-	switch (Condition.Type)
-	{
-		case EObjectiveConditionType::ConquerTerritories:
-		{
-			// Verifica se il giocatore possiede almeno RequiredCount territori
-			return PS->GetNumTerritoriesOwned() >= Condition.RequiredCount;
-		}
-
-		case EObjectiveConditionType::ConquerContinents:
-		{
-			// Conta quanti continenti target il giocatore controlla completamente
-			int32 ControlledCount = 0;
-			for (int32 ContinentID : Condition.TargetContinentIDs)
-			{
-				if (DoesPlayerControlContinent(PlayerID, ContinentID))
-				{
-					ControlledCount++;
-				}
-			}
-			return ControlledCount >= Condition.RequiredCount;
-		}
-
-		case EObjectiveConditionType::ConquerTerritoriesInContinents:
-		{
-			// Conta territori posseduti nei continenti target
-			int32 TotalTerritories = 0;
-			for (int32 ContinentID : Condition.TargetContinentIDs)
-			{
-				TotalTerritories += CountPlayerTerritoriesInContinent(PlayerID, ContinentID);
-			}
-			return TotalTerritories >= Condition.RequiredCount;
-		}
-
-		case EObjectiveConditionType::ControlFullContinent:
-		{
-			// Verifica che il giocatore controlli completamente almeno RequiredCount continenti tra quelli target
-			int32 FullyControlledCount = 0;
-			for (int32 ContinentID : Condition.TargetContinentIDs)
-			{
-				if (DoesPlayerControlContinent(PlayerID, ContinentID))
-				{
-					FullyControlledCount++;
-				}
-			}
-			return FullyControlledCount >= Condition.RequiredCount;
-		}
-
-		case EObjectiveConditionType::EliminatePlayerColor:
-		{
-			// Verifica che il giocatore abbia eliminato un giocatore con uno dei colori target
-			TArray<ARosikoPlayerState*> AllPlayers = GetAllPlayerStates();
-			for (ARosikoPlayerState* OtherPS : AllPlayers)
-			{
-				if (!OtherPS || OtherPS->GameManagerPlayerID == PlayerID)
-				{
-					continue; // Skip self
-				}
-
-				// Verifica se OtherPS ha un colore target ed è stato eliminato da PS
-				for (const FLinearColor& TargetColor : Condition.TargetColors)
-				{
-					if (OtherPS->ArmyColor.Equals(TargetColor, 0.01f) &&
-					    !OtherPS->bIsAlive &&
-					    OtherPS->EliminatedBy == PlayerID)
-					{
-						return true;
-					}
-				}
-			}
-			return false;
-		}
-
-		case EObjectiveConditionType::ControlAdjacentTerritories:
-		{
-			// TODO: Implementare logica per territori confinanti consecutivi
-			// Richiede graph traversal dei territori posseduti
-			UE_LOG(LogRosikoGameManager, Warning, TEXT("ControlAdjacentTerritories not yet implemented"));
-			return false;
-		}
-
-		case EObjectiveConditionType::SurviveUntilTurn:
-		{
-			// Verifica che il giocatore sia vivo, abbia raggiunto il turno richiesto e abbia abbastanza territori
-			return PS->bIsAlive &&
-			       GS->CurrentPlayerTurn >= Condition.RequiredTurn &&
-			       PS->GetNumTerritoriesOwned() >= Condition.MinTerritories;
-		}
-
-		case EObjectiveConditionType::ExchangeCardSets:
-		{
-			// Verifica numero di scambi carte effettuati
-			return PS->CardExchangeCount >= Condition.RequiredCount;
-		}
-
-		case EObjectiveConditionType::Custom:
-		{
-			// Custom objectives richiedono implementazione specifica
-			UE_LOG(LogRosikoGameManager, Warning, TEXT("Custom objective condition - not implemented"));
-			return false;
-		}
-
-		default:
-			UE_LOG(LogRosikoGameManager, Warning, TEXT("Unknown objective condition type: %d"), (int32)Condition.Type);
-			return false;
-	}
-}
-
-bool ARosikoGameManager::DoesPlayerControlContinent(int32 PlayerID, int32 ContinentID)
-{
-	if (!MapGenerator)
-	{
-		return false;
-	}
-
-	ARosikoGameState* GS = GetRosikoGameState();
-	if (!GS)
-	{
-		return false;
-	}
-
-	// Ottieni tutti i territori del continente dal MapGenerator
-	const TArray<FGeneratedTerritory>& AllTerritories = MapGenerator->GetGeneratedTerritories();
-
-	int32 TotalInContinent = 0;
-	int32 OwnedInContinent = 0;
-
-	for (const FGeneratedTerritory& GenTerritory : AllTerritories)
-	{
-		if (GenTerritory.ContinentID == ContinentID && !GenTerritory.bIsOcean)
-		{
-			TotalInContinent++;
-
-			// Verifica se il giocatore lo possiede
-			FTerritoryGameState* TerritoryState = GS->GetTerritory(GenTerritory.ID);
-			if (TerritoryState && TerritoryState->OwnerID == PlayerID)
-			{
-				OwnedInContinent++;
-			}
-		}
-	}
-
-	// Il giocatore controlla il continente se possiede TUTTI i suoi territori
-	return (TotalInContinent > 0) && (OwnedInContinent == TotalInContinent);
-}
-
-int32 ARosikoGameManager::CountPlayerTerritoriesInContinent(int32 PlayerID, int32 ContinentID)
-{
-	if (!MapGenerator)
-	{
-		return 0;
-	}
-
-	ARosikoGameState* GS = GetRosikoGameState();
-	if (!GS)
-	{
-		return 0;
-	}
-
-	const TArray<FGeneratedTerritory>& AllTerritories = MapGenerator->GetGeneratedTerritories();
-	int32 Count = 0;
-
-	for (const FGeneratedTerritory& GenTerritory : AllTerritories)
-	{
-		if (GenTerritory.ContinentID == ContinentID && !GenTerritory.bIsOcean)
-		{
-			FTerritoryGameState* TerritoryState = GS->GetTerritory(GenTerritory.ID);
-			if (TerritoryState && TerritoryState->OwnerID == PlayerID)
-			{
-				Count++;
-			}
-		}
-	}
-
-	return Count;
-}
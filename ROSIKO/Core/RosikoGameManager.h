@@ -2,8 +2,10 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Net/Serialization/FastArraySerializer.h"
 #include "../Configs/GameRulesConfig.h"
 #include "ROSIKO/Configs/ObjectivesConfig.h"
+#include "ObjectiveTracker.h"
 #include "RosikoGameManager.generated.h"
 
 UENUM(BlueprintType)
@@ -54,8 +56,10 @@ struct FPlayerGameState
 	bool bHasSelectedColor = false; // Se true, questo player ha già scelto il colore
 };
 
+struct FTerritoryStateArray;
+
 USTRUCT(BlueprintType)
-struct FTerritoryGameState
+struct FTerritoryGameState : public FFastArraySerializerItem
 {
 	GENERATED_BODY()
 
@@ -67,6 +71,100 @@ struct FTerritoryGameState
 
 	UPROPERTY(BlueprintReadWrite)
 	int32 Troops = 0; // Numero carri armati
+
+	// Callback di replicazione (solo client): aggiornano i visual del territorio
+	void PostReplicatedAdd(const FTerritoryStateArray& InArraySerializer);
+	void PostReplicatedChange(const FTerritoryStateArray& InArraySerializer);
+};
+
+/**
+ * Stato replicato di tutti i territori (delta replication via FastArraySerializer):
+ * viaggiano solo gli elementi marcati con MarkItemDirty, e i client ricevono un callback per elemento.
+ * Dopo ogni modifica lato server chiamare ARosikoGameState::MarkTerritoryDirty (o MarkArrayDirty
+ * per modifiche strutturali).
+ */
+USTRUCT(BlueprintType)
+struct FTerritoryStateArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<FTerritoryGameState> Items;
+
+	// GameState proprietario (non replicato, impostato nel costruttore di ARosikoGameState)
+	class ARosikoGameState* Owner = nullptr;
+
+	// Callback a livello di array (una volta per pacchetto, dopo gli add dei singoli elementi):
+	// ricostruisce la tabella ID -> indice del GameState
+	void PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FTerritoryGameState, FTerritoryStateArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTerritoryStateArray> : public TStructOpsTypeTraitsBase2<FTerritoryStateArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Esito di un attacco risolto dal server (singolo lancio o blitz).
+ * Replicato una sola volta per comando tramite ARosikoGameState::LastCombatResult: in blitz i client
+ * ricevono i totali della sequenza e i dadi dell'ultimo lancio, non un evento per ogni lancio.
+ */
+USTRUCT(BlueprintType)
+struct FCombatResult
+{
+	GENERATED_BODY()
+
+	// Progressivo per comando (garantisce l'OnRep anche con esiti identici)
+	UPROPERTY(BlueprintReadOnly)
+	int32 CombatSequence = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 AttackerID = -1;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 DefenderID = -1;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 FromTerritoryID = -1;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 ToTerritoryID = -1;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bBlitz = false;
+
+	// Lanci eseguiti (1 per attacco singolo)
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumRolls = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 AttackerLosses = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 DefenderLosses = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	bool bConquered = false;
+
+	// Carri spostati nel territorio conquistato
+	UPROPERTY(BlueprintReadOnly)
+	int32 TroopsMoved = 0;
+
+	// Dadi dell'ultimo lancio, ordinati in modo decrescente (per animazione UI)
+	UPROPERTY(BlueprintReadOnly)
+	TArray<uint8> AttackDice;
+
+	UPROPERTY(BlueprintReadOnly)
+	TArray<uint8> DefenseDice;
 };
 
 /**
@@ -227,6 +325,25 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Game State")
 	bool CanPlaceTroops(int32 PlayerID, int32 TerritoryID) const;
 
+	// === COMBATTIMENTO (server) ===
+	// Dadi da CombatRNG (seed casuale solo server, loggato a StartGame), regole da GameRules (MaxAttackDice,
+	// MaxDefenseDice, bAttackerWinsTies, MinTroopsRemaining). Ogni comando produce un solo FCombatResult.
+
+	// Singolo lancio da FromTerritoryID verso ToTerritoryID (NumAttackDice limitato da regole e carri)
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	bool Attack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 NumAttackDice);
+
+	// Blitz: lancia con il massimo dei dadi finché il territorio è conquistato o l'attaccante ha al più
+	// Max(StopAtTroops, MinTroopsRemaining) carri. Il controllo è tra un lancio e l'altro: l'ultimo lancio
+	// può scendere sotto StopAtTroops (mai sotto MinTroopsRemaining). Si ferma anche se un lancio non cambia nulla
+	UFUNCTION(BlueprintCallable, Category = "Combat")
+	bool BlitzAttack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 StopAtTroops);
+
+	// Notifica che lo stato di un territorio è cambiato.
+	// Server: marca l'elemento per la replicazione delta. Ovunque: accoda il refresh dei visual +
+	// OnTerritoryUpdated (coalescente, flush al prossimo tick). Sui client è chiamato dai callback di replicazione.
+	void BroadcastTerritoryUpdate(int32 TerritoryID);
+
 	// === EVENTI (per UI/Notifiche) ===
 
 	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnTerritoryUpdated, int32, TerritoryID);
@@ -249,6 +366,11 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Events")
 	FOnColorSelectionRequired OnColorSelectionRequired;
 
+	// Server: a fine comando. Client: da ARosikoGameState::OnRep_LastCombatResult
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnCombatResolved, const FCombatResult&, Result);
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnCombatResolved OnCombatResolved;
+
 private:
 	// === INIZIALIZZAZIONE ===
 	void InitializePlayers();
@@ -262,12 +384,26 @@ private:
 	// === OBIETTIVI - INTERNAL ===
 	void FilterAndShuffleObjectives(); // Filtra e mescola mazzi obiettivi
 	void AssignObjectivesToPlayer(ARosikoPlayerState* PS); // Assegna obiettivi a un singolo player
-	bool EvaluateObjectiveCondition(const FObjectiveCondition& Condition, ARosikoPlayerState* PS); // Valuta singola condizione
-	bool DoesPlayerControlContinent(int32 PlayerID, int32 ContinentID); // Helper per controllo continenti
-	int32 CountPlayerTerritoriesInContinent(int32 PlayerID, int32 ContinentID); // Conta territori in continente
+	void SyncObjectiveProgress(); // Copia nei PlayerState il progresso degli obiettivi cambiati (per UI)
+
+	// Cambia proprietario di un territorio (server): GameState, PlayerState e tracker obiettivi
+	void SetTerritoryOwner(int32 TerritoryID, int32 NewOwnerID);
+
+	// === COMBATTIMENTO - INTERNAL ===
+
+	// Valida un attacco (fase, turno, proprietà, adiacenza, carri) e ritorna i due territori
+	bool ValidateAttack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID,
+	                    FTerritoryGameState*& OutFrom, FTerritoryGameState*& OutTo) const;
+
+	// Un lancio: tira i dadi, confronta le coppie e sottrae le perdite dai territori
+	void RollCombatRound(int32 NumAttackDice, FTerritoryGameState& From, FTerritoryGameState& To, FCombatResult& Result);
+
+	// Applica conquista/dirty/eventi e pubblica il risultato (un solo aggiornamento per comando)
+	void FinishCombat(FTerritoryGameState& From, FTerritoryGameState& To, FCombatResult& Result);
 
 	// === HELPERS ===
-	void BroadcastTerritoryUpdate(int32 TerritoryID); // Aggiorna visuals + evento
+	void FlushTerritoryUpdates(); // Aggiorna visuals + OnTerritoryUpdated per i territori sporchi, una volta per frame
+	void UpdateTerritoryVisuals(class ATerritoryActor* Territory, const FTerritoryGameState& State);
 	void BroadcastPlayerUpdate(int32 PlayerID);
 	void RefreshAllTerritoryDisplays(); // Forza refresh di tutti i territori (chiamato all'inizio)
 	void ChangePhase(EGamePhase NewPhase);
@@ -280,9 +416,22 @@ private:
 	// RNG per shuffle carte/distribuzione (usa stesso seed di MapGenerator per determinismo)
 	FRandomStream GameRNG;
 
+	// RNG dei dadi (server, seed casuale non replicato): stream separato da GameRNG, così
+	// shuffle/distribuzione restano riproducibili indipendentemente dal numero di combattimenti
+	FRandomStream CombatRNG;
+	int32 CombatSequence = 0;
+
+	// Valutazione incrementale degli obiettivi assegnati (server)
+	FObjectiveTracker ObjectiveTracker;
+
 	// Timer per aggiornare GameTimeSeconds ogni secondo
 	FTimerHandle GameTimeUpdateTimer;
 
+	// Territori modificati nel frame corrente (ordine di prima modifica + maschera per ID per deduplicare)
+	TArray<int32> DirtyTerritoryIDs;
+	TBitArray<> DirtyTerritoryMask;
+	bool bTerritoryFlushPending = false;
+
 	// === REPLICATION CALLBACKS (DEPRECATI, ora in GameState) ===
 
 	// DEPRECATO: Ora in ARosikoGameState::OnRep_CurrentPhase
@@ -296,8 +445,4 @@ private:
 	// Multicast RPC per notificare i client del cambio turno durante ColorSelection
 	UFUNCTION(NetMulticast, Reliable)
 	void Multicast_NotifyColorSelectionTurn(int32 PlayerID, const TArray<FLinearColor>& AvailableColorsList);
-
-	// Multicast RPC per notificare tutti i client di un update territorio
-	UFUNCTION(NetMulticast, Reliable)
-	void Multicast_NotifyTerritoryUpdate(int32 TerritoryID, int32 OwnerID, int32 TroopCount);
 };
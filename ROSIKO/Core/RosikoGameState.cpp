@@ -1,5 +1,6 @@
 #include "RosikoGameState.h"
 #include "RosikoPlayerState.h"
+#include "../Map/MapDataStructs.h"
 #include "Net/UnrealNetwork.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogRosikoGameState, Log, All);
@@ -9,6 +10,9 @@ ARosikoGameState::ARosikoGameState()
 	// Abilita replicazione
 	bReplicates = true;
 	bAlwaysRelevant = true;
+
+	// Callback di replicazione dei territori
+	Territories.Owner = this;
 }
 
 void ARosikoGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
@@ -17,6 +21,7 @@ void ARosikoGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 
 	DOREPLIFETIME(ARosikoGameState, CurrentPhase);
 	DOREPLIFETIME(ARosikoGameState, CurrentPlayerTurn);
+	DOREPLIFETIME(ARosikoGameState, CurrentRound);
 	DOREPLIFETIME(ARosikoGameState, TurnOrder);
 	DOREPLIFETIME(ARosikoGameState, Territories);
 	DOREPLIFETIME(ARosikoGameState, AvailableColors);
@@ -25,6 +30,7 @@ void ARosikoGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 	DOREPLIFETIME(ARosikoGameState, MapSeed);
 	DOREPLIFETIME(ARosikoGameState, ExpectedPlayerCount);
 	DOREPLIFETIME(ARosikoGameState, ReadyPlayerIDs);
+	DOREPLIFETIME(ARosikoGameState, LastCombatResult);
 }
 
 void ARosikoGameState::OnRep_CurrentPhase()
@@ -64,29 +70,170 @@ void ARosikoGameState::OnRep_ReadyPlayerIDs()
 	OnReadyPlayersChanged.Broadcast();
 }
 
-FTerritoryGameState* ARosikoGameState::GetTerritory(int32 TerritoryID)
+void ARosikoGameState::OnRep_LastCombatResult()
+{
+	if (!CachedGameManager.IsValid())
+	{
+		for (TActorIterator<ARosikoGameManager> It(GetWorld()); It; ++It)
+		{
+			CachedGameManager = *It;
+			break;
+		}
+	}
+
+	// I territori coinvolti arrivano con la replicazione delta di Territories: qui solo l'evento per UI/animazioni
+	if (ARosikoGameManager* GM = CachedGameManager.Get())
+	{
+		GM->OnCombatResolved.Broadcast(LastCombatResult);
+	}
+}
+
+void FTerritoryGameState::PostReplicatedAdd(const FTerritoryStateArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleTerritoryReplicated(TerritoryID);
+	}
+}
+
+void FTerritoryGameState::PostReplicatedChange(const FTerritoryStateArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleTerritoryReplicated(TerritoryID);
+	}
+}
+
+void FTerritoryStateArray::PostReplicatedAdd(const TArrayView<int32>& AddedIndices, int32 FinalSize)
+{
+	// Il server invia gli elementi nel suo ordine: basta ricostruire la tabella ID -> indice
+	if (Owner)
+	{
+		Owner->RebuildTerritoryIndex();
+	}
+}
+
+void ARosikoGameState::HandleTerritoryReplicated(int32 TerritoryID)
+{
+	if (!CachedGameManager.IsValid())
+	{
+		for (TActorIterator<ARosikoGameManager> It(GetWorld()); It; ++It)
+		{
+			CachedGameManager = *It;
+			break;
+		}
+	}
+
+	// Refresh visual + OnTerritoryUpdated (coalescente, al prossimo tick)
+	if (ARosikoGameManager* GM = CachedGameManager.Get())
+	{
+		GM->BroadcastTerritoryUpdate(TerritoryID);
+	}
+	else
+	{
+		// Il GameManager non è ancora replicato: l'update parte alla sua BeginPlay
+		PendingTerritoryUpdates.Add(TerritoryID);
+	}
+}
+
+void ARosikoGameState::RegisterGameManager(ARosikoGameManager* GameManager)
 {
-	for (FTerritoryGameState& Territory : Territories)
+	if (!GameManager)
+	{
+		return;
+	}
+
+	CachedGameManager = GameManager;
+
+	if (PendingTerritoryUpdates.Num() > 0)
 	{
-		if (Territory.TerritoryID == TerritoryID)
+		UE_LOG(LogRosikoGameState, Log, TEXT("RegisterGameManager - flushing %d territory updates received before the GameManager"),
+		       PendingTerritoryUpdates.Num());
+
+		for (int32 TerritoryID : PendingTerritoryUpdates)
+		{
+			GameManager->BroadcastTerritoryUpdate(TerritoryID);
+		}
+		PendingTerritoryUpdates.Empty();
+	}
+}
+
+void ARosikoGameState::MarkTerritoryDirty(int32 TerritoryID)
+{
+	const int32 Index = FindTerritoryIndex(TerritoryID);
+	if (Index != INDEX_NONE)
+	{
+		Territories.MarkItemDirty(Territories.Items[Index]);
+	}
+}
+
+void ARosikoGameState::RebuildTerritoryIndex()
+{
+	int32 MaxID = -1;
+	for (const FTerritoryGameState& Territory : Territories.Items)
+	{
+		MaxID = FMath::Max(MaxID, Territory.TerritoryID);
+	}
+
+	TerritoryIndexByID.Init(INDEX_NONE, MaxID + 1);
+	for (int32 Index = 0; Index < Territories.Items.Num(); Index++)
+	{
+		const int32 TerritoryID = Territories.Items[Index].TerritoryID;
+		if (TerritoryID >= 0)
+		{
+			TerritoryIndexByID[TerritoryID] = Index;
+		}
+	}
+}
+
+int32 ARosikoGameState::FindTerritoryIndex(int32 TerritoryID) const
+{
+	// Tabella costruita: lookup diretto, con verifica che l'entry punti ancora al territorio giusto
+	if (TerritoryIndexByID.Num() > 0)
+	{
+		if (!TerritoryIndexByID.IsValidIndex(TerritoryID))
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Index = TerritoryIndexByID[TerritoryID];
+		if (Index == INDEX_NONE || (Territories.Items.IsValidIndex(Index) && Territories.Items[Index].TerritoryID == TerritoryID))
 		{
-			return &Territory;
+			return Index;
 		}
 	}
 
+	// Tabella non ancora costruita o non allineata (replicazione in corso): fallback lineare, sempre corretto
+	return Territories.Items.IndexOfByPredicate([TerritoryID](const FTerritoryGameState& Territory)
+	{
+		return Territory.TerritoryID == TerritoryID;
+	});
+}
+
+FTerritoryGameState* ARosikoGameState::GetTerritory(int32 TerritoryID)
+{
+	const int32 Index = FindTerritoryIndex(TerritoryID);
+	if (Index != INDEX_NONE)
+	{
+		return &Territories.Items[Index];
+	}
+
 	UE_LOG(LogRosikoGameState, Warning, TEXT("GetTerritory - Territory %d not found!"), TerritoryID);
 	return nullptr;
 }
 
+const FTerritoryGameState* ARosikoGameState::GetTerritory(int32 TerritoryID) const
+{
+	return const_cast<ARosikoGameState*>(this)->GetTerritory(TerritoryID);
+}
+
 FTerritoryGameState ARosikoGameState::GetTerritoryByID(int32 TerritoryID, bool& bFound) const
 {
-	for (const FTerritoryGameState& Territory : Territories)
+	const int32 Index = FindTerritoryIndex(TerritoryID);
+	if (Index != INDEX_NONE)
 	{
-		if (Territory.TerritoryID == TerritoryID)
-		{
-			bFound = true;
-			return Territory;
-		}
+		bFound = true;
+		return Territories.Items[Index];
 	}
 
 	bFound = false;
@@ -95,6 +242,113 @@ FTerritoryGameState ARosikoGameState::GetTerritoryByID(int32 TerritoryID, bool&
 	return Invalid;
 }
 
+// === CONTROLLO CONTINENTI ===
+
+void ARosikoGameState::InitializeContinentOwnership(const TArray<FGeneratedTerritory>& GeneratedTerritories, int32 NumPlayers)
+{
+	int32 NumContinents = 0;
+	int32 MaxTerritoryID = -1;
+	for (const FGeneratedTerritory& GenTerritory : GeneratedTerritories)
+	{
+		if (GenTerritory.bIsOcean) continue;
+
+		NumContinents = FMath::Max(NumContinents, GenTerritory.ContinentID + 1);
+		MaxTerritoryID = FMath::Max(MaxTerritoryID, GenTerritory.ID);
+	}
+
+	TerritoryContinentByID.Init(INDEX_NONE, MaxTerritoryID + 1);
+	ContinentTerritoryCounts.Init(0, NumContinents);
+	for (const FGeneratedTerritory& GenTerritory : GeneratedTerritories)
+	{
+		if (GenTerritory.bIsOcean || GenTerritory.ID < 0 || GenTerritory.ContinentID < 0) continue;
+
+		TerritoryContinentByID[GenTerritory.ID] = GenTerritory.ContinentID;
+		ContinentTerritoryCounts[GenTerritory.ContinentID]++;
+	}
+
+	NumContinentPlayers = FMath::Max(NumPlayers, 0);
+	ContinentOwnedCounts.Init(0, NumContinentPlayers * NumContinents);
+
+	// Territori già assegnati (es. re-inizializzazione a partita in corso)
+	for (const FTerritoryGameState& Territory : Territories.Items)
+	{
+		const int32 ContinentID = TerritoryContinentByID.IsValidIndex(Territory.TerritoryID) ? TerritoryContinentByID[Territory.TerritoryID] : INDEX_NONE;
+		if (ContinentID != INDEX_NONE && Territory.OwnerID >= 0 && Territory.OwnerID < NumContinentPlayers)
+		{
+			ContinentOwnedCounts[Territory.OwnerID * NumContinents + ContinentID]++;
+		}
+	}
+}
+
+void ARosikoGameState::SetTerritoryOwner(int32 TerritoryID, int32 NewOwnerID)
+{
+	FTerritoryGameState* Territory = GetTerritory(TerritoryID);
+	if (!Territory || Territory->OwnerID == NewOwnerID)
+	{
+		return;
+	}
+
+	const int32 NumContinents = GetNumContinents();
+	const int32 ContinentID = TerritoryContinentByID.IsValidIndex(TerritoryID) ? TerritoryContinentByID[TerritoryID] : INDEX_NONE;
+	if (ContinentID != INDEX_NONE)
+	{
+		// PlayerID oltre quelli previsti all'inizializzazione: allarga la matrice
+		if (NewOwnerID >= NumContinentPlayers)
+		{
+			NumContinentPlayers = NewOwnerID + 1;
+			ContinentOwnedCounts.SetNumZeroed(NumContinentPlayers * NumContinents);
+		}
+
+		if (Territory->OwnerID >= 0 && Territory->OwnerID < NumContinentPlayers)
+		{
+			ContinentOwnedCounts[Territory->OwnerID * NumContinents + ContinentID]--;
+		}
+		if (NewOwnerID >= 0)
+		{
+			ContinentOwnedCounts[NewOwnerID * NumContinents + ContinentID]++;
+		}
+	}
+
+	TerritoryRegions.SetOwner(TerritoryID, NewOwnerID);
+
+	Territory->OwnerID = NewOwnerID;
+}
+
+void ARosikoGameState::InitializeTerritoryRegions(const AMapGenerator& MapGenerator)
+{
+	TerritoryRegions.Initialize(MapGenerator);
+
+	// Territori già assegnati (es. re-inizializzazione a partita in corso), come InitializeContinentOwnership
+	for (const FTerritoryGameState& Territory : Territories.Items)
+	{
+		if (Territory.OwnerID >= 0)
+		{
+			TerritoryRegions.SetOwner(Territory.TerritoryID, Territory.OwnerID);
+		}
+	}
+}
+
+int32 ARosikoGameState::GetContinentTerritoryCount(int32 ContinentID) const
+{
+	return ContinentTerritoryCounts.IsValidIndex(ContinentID) ? ContinentTerritoryCounts[ContinentID] : 0;
+}
+
+int32 ARosikoGameState::GetOwnedTerritoriesInContinent(int32 PlayerID, int32 ContinentID) const
+{
+	if (PlayerID < 0 || PlayerID >= NumContinentPlayers || !ContinentTerritoryCounts.IsValidIndex(ContinentID))
+	{
+		return 0;
+	}
+
+	return ContinentOwnedCounts[PlayerID * GetNumContinents() + ContinentID];
+}
+
+bool ARosikoGameState::DoesPlayerControlContinent(int32 PlayerID, int32 ContinentID) const
+{
+	const int32 TotalInContinent = GetContinentTerritoryCount(ContinentID);
+	return (TotalInContinent > 0) && (GetOwnedTerritoriesInContinent(PlayerID, ContinentID) == TotalInContinent);
+}
+
 int32 ARosikoGameState::GetCurrentPlayerID() const
 {
 	if (TurnOrder.IsValidIndex(CurrentPlayerTurn))
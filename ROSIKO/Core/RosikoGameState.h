@@ -3,9 +3,12 @@
 #include "CoreMinimal.h"
 #include "GameFramework/GameStateBase.h"
 #include "RosikoGameManager.h" // Per EGamePhase e FTerritoryGameState
+#include "TerritoryRegionTracker.h"
 #include "EngineUtils.h" // Per TActorIterator
 #include "RosikoGameState.generated.h"
 
+struct FGeneratedTerritory;
+
 /**
  * GameState per ROSIKO.
  * Contiene lo stato globale della partita, replicato a tutti i client.
@@ -39,13 +42,20 @@ public:
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing=OnRep_CurrentPlayerTurn, Category = "Game State")
 	int32 CurrentPlayerTurn = 0;
 
+	// Giro di gioco corrente: 1 al primo Reinforce dopo la distribuzione iniziale,
+	// +1 ogni volta che TurnOrder ricomincia dal primo giocatore (0 prima della partita vera)
+	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Game State")
+	int32 CurrentRound = 0;
+
 	// Ordine turni randomizzato (array di PlayerID)
 	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Game State")
 	TArray<int32> TurnOrder;
 
-	// Stato di tutti i territori
+	// Stato di tutti i territori, replicato a delta (solo gli elementi modificati).
+	// Oceani esclusi, quindi l'indice NON coincide con TerritoryID: per l'accesso per ID usare GetTerritory,
+	// che passa da TerritoryIndexByID. Dopo ogni modifica lato server chiamare MarkTerritoryDirty.
 	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Game State")
-	TArray<FTerritoryGameState> Territories;
+	FTerritoryStateArray Territories;
 
 	// Colori ancora disponibili per selezione
 	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Game State")
@@ -72,6 +82,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing=OnRep_ReadyPlayerIDs, Category = "Game State")
 	TArray<int32> ReadyPlayerIDs;
 
+	// Esito dell'ultimo attacco (uno per comando, anche in blitz)
+	UPROPERTY(BlueprintReadOnly, ReplicatedUsing=OnRep_LastCombatResult, Category = "Game State")
+	FCombatResult LastCombatResult;
+
 	// === EVENTI REPLICAZIONE ===
 
 	UFUNCTION()
@@ -83,6 +97,9 @@ public:
 	UFUNCTION()
 	void OnRep_ReadyPlayerIDs();
 
+	UFUNCTION()
+	void OnRep_LastCombatResult();
+
 	// === DELEGATE PER UI ===
 
 	// Chiamato quando la lista di player pronti cambia (per aggiornare LoadingScreen)
@@ -92,8 +109,64 @@ public:
 
 	// === HELPER METHODS ===
 
-	// Ottieni territorio per ID (solo C++, ritorna puntatore per efficienza)
+	// Ottieni territorio per ID (solo C++, ritorna puntatore per efficienza). O(1) tramite TerritoryIndexByID
 	FTerritoryGameState* GetTerritory(int32 TerritoryID);
+	const FTerritoryGameState* GetTerritory(int32 TerritoryID) const;
+
+	// Stato di tutti i territori (Blueprint-safe)
+	UFUNCTION(BlueprintPure, Category = "Game State")
+	const TArray<FTerritoryGameState>& GetTerritories() const { return Territories.Items; }
+
+	// Ricostruisce la tabella TerritoryID -> indice in Territories.
+	// Da chiamare dopo ogni modifica strutturale di Territories (server) e dopo la replicazione (client)
+	void RebuildTerritoryIndex();
+
+	// Server: marca il territorio per la replicazione delta (da chiamare dopo averne modificato lo stato)
+	void MarkTerritoryDirty(int32 TerritoryID);
+
+	// Client: un territorio è stato aggiunto/modificato dalla replicazione
+	void HandleTerritoryReplicated(int32 TerritoryID);
+
+	// Client: il GameManager è arrivato (BeginPlay), riceve gli update accodati in sua assenza
+	void RegisterGameManager(ARosikoGameManager* GameManager);
+
+	// === CONTROLLO CONTINENTI (server) ===
+	// Matrice [player x continente] dei territori posseduti + totali per continente,
+	// aggiornata in modo incrementale da SetTerritoryOwner: le query sono O(1).
+
+	// Calcola i totali per continente e azzera i conteggi (chiamato dopo aver popolato Territories)
+	void InitializeContinentOwnership(const TArray<FGeneratedTerritory>& GeneratedTerritories, int32 NumPlayers);
+
+	// Unico punto in cui cambia OwnerID lato server: aggiorna anche i contatori per continente.
+	// Non marca l'elemento per la replicazione (lo fa ARosikoGameManager::BroadcastTerritoryUpdate)
+	void SetTerritoryOwner(int32 TerritoryID, int32 NewOwnerID);
+
+	int32 GetNumContinents() const { return ContinentTerritoryCounts.Num(); }
+
+	// Continente del territorio (INDEX_NONE se oceano / sconosciuto)
+	int32 GetTerritoryContinent(int32 TerritoryID) const
+	{
+		return TerritoryContinentByID.IsValidIndex(TerritoryID) ? TerritoryContinentByID[TerritoryID] : INDEX_NONE;
+	}
+
+	// Territori (non oceano) nel continente
+	int32 GetContinentTerritoryCount(int32 ContinentID) const;
+
+	// Territori del continente posseduti dal player
+	int32 GetOwnedTerritoriesInContinent(int32 PlayerID, int32 ContinentID) const;
+
+	// Il player possiede TUTTI i territori del continente
+	bool DoesPlayerControlContinent(int32 PlayerID, int32 ContinentID) const;
+
+	// === REGIONI CONTIGUE (server) ===
+	// Componenti connesse dei territori di ogni player sul grafo di adiacenza, aggiornate
+	// da SetTerritoryOwner (union su conquista, ricalcolo della sola componente toccata su perdita).
+
+	// Copia l'adiacenza dal generatore e riparte dai proprietari correnti (chiamato dopo InitializeContinentOwnership)
+	void InitializeTerritoryRegions(const AMapGenerator& MapGenerator);
+
+	// Territori della regione contigua più grande posseduta dal player (O(1))
+	int32 GetLargestOwnedRegion(int32 PlayerID) const { return TerritoryRegions.GetLargestRegion(PlayerID); }
 
 	// Ottieni territorio per ID (Blueprint-safe, ritorna copia)
 	UFUNCTION(BlueprintCallable, Category = "Game State")
@@ -133,5 +206,30 @@ public:
 	// Ottieni lista nomi player non ancora pronti
 	UFUNCTION(BlueprintPure, Category = "Game State")
 	TArray<FString> GetNotReadyPlayerNames() const;
+
+private:
+	// TerritoryID -> indice in Territories (INDEX_NONE per ID senza stato, es. oceani). Non replicata:
+	// ogni macchina la ricostruisce localmente
+	TArray<int32> TerritoryIndexByID;
+
+	int32 FindTerritoryIndex(int32 TerritoryID) const;
+
+	// Continente di ogni territorio (INDEX_NONE per oceani / ID senza stato)
+	TArray<int32> TerritoryContinentByID;
+
+	// Territori per continente
+	TArray<int32> ContinentTerritoryCounts;
+
+	// Territori posseduti, indicizzati [PlayerID * GetNumContinents() + ContinentID]
+	TArray<int32> ContinentOwnedCounts;
+	int32 NumContinentPlayers = 0;
+
+	FTerritoryRegionTracker TerritoryRegions;
+
+	// GameManager (cache per i callback di replicazione dei territori)
+	TWeakObjectPtr<ARosikoGameManager> CachedGameManager;
+
+	// Territori replicati prima del GameManager (i duplicati si fondono in BroadcastTerritoryUpdate)
+	TArray<int32> PendingTerritoryUpdates;
 };
 
@@ -165,6 +165,82 @@ void ARosikoPlayerController::Server_PlaceTroops_Implementation(int32 PlayerID,
 	GameManager->PlaceTroops(PlayerID, TerritoryID, Amount);
 }
 
+bool ARosikoPlayerController::Server_Attack_Validate(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 NumAttackDice)
+{
+	// Accetta sempre (validazione soft in Implementation per non disconnettere client)
+	return true;
+}
+
+void ARosikoPlayerController::Server_Attack_Implementation(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 NumAttackDice)
+{
+	// === VALIDAZIONE SECURITY: Il client può attaccare SOLO con il proprio PlayerID ===
+	ARosikoPlayerState* PS = GetPlayerState<ARosikoPlayerState>();
+	if (!PS || PS->GameManagerPlayerID != PlayerID)
+	{
+		UE_LOG(LogRosikoPlayerController, Error, TEXT("Server_Attack - CHEATING ATTEMPT BLOCKED! Client (PlayerID %d) tried to attack as PlayerID %d"),
+		       PS ? PS->GameManagerPlayerID : -1, PlayerID);
+		return;
+	}
+
+	if (FromTerritoryID < 0 || ToTerritoryID < 0 || FromTerritoryID == ToTerritoryID || NumAttackDice <= 0)
+	{
+		UE_LOG(LogRosikoPlayerController, Warning, TEXT("Server_Attack - invalid request %d -> %d (%d dice), ignoring"),
+		       FromTerritoryID, ToTerritoryID, NumAttackDice);
+		return;
+	}
+
+	if (!GameManager)
+	{
+		FindGameManager();
+	}
+
+	if (!GameManager)
+	{
+		UE_LOG(LogRosikoPlayerController, Error, TEXT("Cannot attack: GameManager not found"));
+		return;
+	}
+
+	GameManager->Attack(PlayerID, FromTerritoryID, ToTerritoryID, NumAttackDice);
+}
+
+bool ARosikoPlayerController::Server_BlitzAttack_Validate(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 StopAtTroops)
+{
+	// Accetta sempre (validazione soft in Implementation per non disconnettere client)
+	return true;
+}
+
+void ARosikoPlayerController::Server_BlitzAttack_Implementation(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 StopAtTroops)
+{
+	// === VALIDAZIONE SECURITY: Il client può attaccare SOLO con il proprio PlayerID ===
+	ARosikoPlayerState* PS = GetPlayerState<ARosikoPlayerState>();
+	if (!PS || PS->GameManagerPlayerID != PlayerID)
+	{
+		UE_LOG(LogRosikoPlayerController, Error, TEXT("Server_BlitzAttack - CHEATING ATTEMPT BLOCKED! Client (PlayerID %d) tried to attack as PlayerID %d"),
+		       PS ? PS->GameManagerPlayerID : -1, PlayerID);
+		return;
+	}
+
+	if (FromTerritoryID < 0 || ToTerritoryID < 0 || FromTerritoryID == ToTerritoryID || StopAtTroops < 0)
+	{
+		UE_LOG(LogRosikoPlayerController, Warning, TEXT("Server_BlitzAttack - invalid request %d -> %d (stop at %d), ignoring"),
+		       FromTerritoryID, ToTerritoryID, StopAtTroops);
+		return;
+	}
+
+	if (!GameManager)
+	{
+		FindGameManager();
+	}
+
+	if (!GameManager)
+	{
+		UE_LOG(LogRosikoPlayerController, Error, TEXT("Cannot blitz attack: GameManager not found"));
+		return;
+	}
+
+	GameManager->BlitzAttack(PlayerID, FromTerritoryID, ToTerritoryID, StopAtTroops);
+}
+
 void ARosikoPlayerController::Server_NotifyClientReady_Implementation()
 {
 	UE_LOG(LogRosikoPlayerController, Warning, TEXT("Server_NotifyClientReady - Client is ready"));
@@ -47,6 +47,14 @@ public:
 	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Game Commands")
 	void Server_PlaceTroops(int32 PlayerID, int32 TerritoryID, int32 Amount);
 
+	// Client richiede un singolo lancio di attacco
+	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Game Commands")
+	void Server_Attack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 NumAttackDice);
+
+	// Client richiede un attacco blitz (risolto interamente sul server, un solo risultato replicato)
+	UFUNCTION(Server, Reliable, WithValidation, BlueprintCallable, Category = "Game Commands")
+	void Server_BlitzAttack(int32 PlayerID, int32 FromTerritoryID, int32 ToTerritoryID, int32 StopAtTroops);
+
 	// Client notifica il server che ha completato la generazione mappa ed è pronto
 	UFUNCTION(Server, Reliable, BlueprintCallable, Category = "Game Commands")
 	void Server_NotifyClientReady();
@@ -326,3 +326,24 @@ void ARosikoPlayerState::CompleteSecondaryObjective(int32 SecondaryIndex, int32
 	       GameManagerPlayerID, *Objective.Definition.DisplayName.ToString(),
 	       Objective.Definition.VictoryPoints, CompletionTurn);
 }
+
+void ARosikoPlayerState::SetObjectiveProgress(int32 Slot, const TArray<int32>& Progress, const TArray<int32>& Targets)
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	FAssignedObjective* Objective = (Slot < 0) ? &MainObjective
+		: (SecondaryObjectives.IsValidIndex(Slot) ? &SecondaryObjectives[Slot] : nullptr);
+	if (!Objective)
+	{
+		return;
+	}
+
+	Objective->ConditionProgress = Progress;
+	Objective->ConditionTargets = Targets;
+
+	// Broadcast anche sul server (OnRep non viene chiamato sul server)
+	OnObjectivesUpdated.Broadcast();
+}
@@ -49,7 +49,8 @@ public:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Game State")
 	TArray<FTerritoryCard> Hand;
 
-	// Numero di scambi carte effettuati (per calcolo bonus progressivo)
+	// Numero di scambi carte effettuati (per calcolo bonus progressivo).
+	// Ogni modifica (server) va seguita da ObjectiveTracker.NotifyCardSetExchanged nel GameManager
 	UPROPERTY(Replicated, BlueprintReadOnly, Category = "Game State")
 	int32 CardExchangeCount = 0;
 
@@ -179,5 +180,8 @@ public:
 
 	// Marca obiettivo secondario come completato (per index)
 	void CompleteSecondaryObjective(int32 SecondaryIndex, int32 CompletionTurn, float CompletionTime);
+
+	// Aggiorna il progresso delle condizioni di un obiettivo (Slot -1 = principale, 0..N-1 = secondari)
+	void SetObjectiveProgress(int32 Slot, const TArray<int32>& Progress, const TArray<int32>& Targets);
 };
 
@@ -0,0 +1,184 @@
+#include "TerritoryRegionTracker.h"
+#include "../Map/MapGenerator.h"
+
+void FTerritoryRegionTracker::Initialize(const AMapGenerator& MapGenerator)
+{
+	const int32 NumTerritories = MapGenerator.GetGeneratedTerritories().Num();
+
+	AdjacencyOffsets.Init(0, NumTerritories + 1);
+	AdjacencyIndices.Reset();
+	for (int32 T = 0; T < NumTerritories; T++)
+	{
+		AdjacencyIndices.Append(MapGenerator.GetTerritoryNeighbors(T));
+		AdjacencyOffsets[T + 1] = AdjacencyIndices.Num();
+	}
+
+	Owner.Init(-1, NumTerritories);
+	Size.Init(1, NumTerritories);
+	Parent.SetNumUninitialized(NumTerritories);
+	for (int32 T = 0; T < NumTerritories; T++)
+	{
+		Parent[T] = T;
+	}
+
+	Players.Reset();
+	VisitStamp.Init(0, NumTerritories);
+	CurrentStamp = 0;
+}
+
+void FTerritoryRegionTracker::SetOwner(int32 TerritoryID, int32 NewOwnerID)
+{
+	if (!Owner.IsValidIndex(TerritoryID) || Owner[TerritoryID] == NewOwnerID)
+	{
+		return;
+	}
+
+	const int32 OldOwnerID = Owner[TerritoryID];
+	Owner[TerritoryID] = NewOwnerID;
+
+	if (OldOwnerID >= 0)
+	{
+		SplitAfterLoss(TerritoryID, OldOwnerID);
+	}
+
+	// Territorio isolato come nuova componente, poi union con i vicini dello stesso proprietario
+	Parent[TerritoryID] = TerritoryID;
+	Size[TerritoryID] = 1;
+
+	if (NewOwnerID >= 0)
+	{
+		if (NewOwnerID >= Players.Num())
+		{
+			Players.SetNum(NewOwnerID + 1);
+		}
+		AddRegion(NewOwnerID, 1);
+
+		for (int32 Neighbor : GetNeighbors(TerritoryID))
+		{
+			if (Owner[Neighbor] == NewOwnerID)
+			{
+				Union(TerritoryID, Neighbor);
+			}
+		}
+	}
+}
+
+int32 FTerritoryRegionTracker::GetRegionSize(int32 TerritoryID)
+{
+	if (!Owner.IsValidIndex(TerritoryID) || Owner[TerritoryID] < 0)
+	{
+		return 0;
+	}
+	return Size[Find(TerritoryID)];
+}
+
+int32 FTerritoryRegionTracker::Find(int32 TerritoryID)
+{
+	// Path halving
+	while (Parent[TerritoryID] != TerritoryID)
+	{
+		Parent[TerritoryID] = Parent[Parent[TerritoryID]];
+		TerritoryID = Parent[TerritoryID];
+	}
+	return TerritoryID;
+}
+
+void FTerritoryRegionTracker::Union(int32 TerritoryA, int32 TerritoryB)
+{
+	int32 RootA = Find(TerritoryA);
+	int32 RootB = Find(TerritoryB);
+	if (RootA == RootB)
+	{
+		return;
+	}
+
+	// Union by size
+	if (Size[RootA] < Size[RootB])
+	{
+		Swap(RootA, RootB);
+	}
+
+	// Prima la regione unita, poi le parti: LargestRegion sale subito alla nuova dimensione
+	// e la rimozione delle parti non deve mai riscandire l'istogramma
+	const int32 PlayerID = Owner[RootA];
+	const int32 SizeA = Size[RootA];
+	const int32 SizeB = Size[RootB];
+
+	Parent[RootB] = RootA;
+	Size[RootA] = SizeA + SizeB;
+
+	AddRegion(PlayerID, Size[RootA]);
+	RemoveRegion(PlayerID, SizeA);
+	RemoveRegion(PlayerID, SizeB);
+}
+
+void FTerritoryRegionTracker::AddRegion(int32 PlayerID, int32 RegionSize)
+{
+	FPlayerRegions& Regions = Players[PlayerID];
+	if (RegionSize >= Regions.SizeHistogram.Num())
+	{
+		Regions.SizeHistogram.SetNumZeroed(RegionSize + 1);
+	}
+	Regions.SizeHistogram[RegionSize]++;
+	Regions.LargestRegion = FMath::Max(Regions.LargestRegion, RegionSize);
+}
+
+void FTerritoryRegionTracker::RemoveRegion(int32 PlayerID, int32 RegionSize)
+{
+	FPlayerRegions& Regions = Players[PlayerID];
+	Regions.SizeHistogram[RegionSize]--;
+
+	// La regione più grande è sparita davvero: scendiamo fino alla prossima dimensione presente
+	while (Regions.LargestRegion > 0 && Regions.SizeHistogram[Regions.LargestRegion] == 0)
+	{
+		Regions.LargestRegion--;
+	}
+}
+
+void FTerritoryRegionTracker::SplitAfterLoss(int32 TerritoryID, int32 OldOwnerID)
+{
+	// Owner[TerritoryID] è già il nuovo proprietario: la BFS non lo attraversa.
+	// La vecchia regione si rimuove solo dopo aver aggiunto i pezzi, così la riscansione
+	// dell'istogramma avviene solo se la regione più grande si è davvero ridotta
+	const int32 OldSize = Size[Find(TerritoryID)];
+
+	// Ogni vicino del vecchio proprietario non ancora visitato è il seme di una componente residua
+	CurrentStamp++;
+	for (int32 Seed : GetNeighbors(TerritoryID))
+	{
+		if (Owner[Seed] != OldOwnerID || VisitStamp[Seed] == CurrentStamp)
+		{
+			continue;
+		}
+
+		Members.Reset();
+		Queue.Reset();
+		Queue.Add(Seed);
+		VisitStamp[Seed] = CurrentStamp;
+
+		for (int32 Head = 0; Head < Queue.Num(); Head++)
+		{
+			const int32 Current = Queue[Head];
+			Members.Add(Current);
+
+			for (int32 Neighbor : GetNeighbors(Current))
+			{
+				if (Owner[Neighbor] == OldOwnerID && VisitStamp[Neighbor] != CurrentStamp)
+				{
+					VisitStamp[Neighbor] = CurrentStamp;
+					Queue.Add(Neighbor);
+				}
+			}
+		}
+
+		// La componente residua diventa piatta con radice Seed
+		for (int32 Member : Members)
+		{
+			Parent[Member] = Seed;
+		}
+		Size[Seed] = Members.Num();
+		AddRegion(OldOwnerID, Members.Num());
+	}
+
+	RemoveRegion(OldOwnerID, OldSize);
+}
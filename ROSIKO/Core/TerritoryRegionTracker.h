@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AMapGenerator;
+
+/**
+ * Regioni connesse di territori posseduti dallo stesso giocatore (per ControlAdjacentTerritories).
+ *
+ * Union-find sui territori (ogni componente contiene solo territori dello stesso proprietario):
+ * - conquista: union con i vicini dello stesso proprietario, quasi O(1)
+ * - perdita: l'union-find non supporta lo split, quindi si ricalcola con una BFS solo la componente
+ *   che conteneva il territorio perso (O(dimensione componente))
+ *
+ * Per ogni giocatore un istogramma delle dimensioni delle componenti mantiene la regione più grande,
+ * interrogabile in O(1).
+ */
+class ROSIKO_API FTerritoryRegionTracker
+{
+public:
+	// Copia il grafo di adiacenza (CSR) dal generatore e azzera tutti i proprietari (poi SetOwner per quelli correnti)
+	void Initialize(const AMapGenerator& MapGenerator);
+
+	// Aggiorna le componenti per il cambio di proprietario (NewOwnerID = -1 per neutrale)
+	void SetOwner(int32 TerritoryID, int32 NewOwnerID);
+
+	// Numero di territori della regione contigua più grande del giocatore
+	int32 GetLargestRegion(int32 PlayerID) const
+	{
+		return Players.IsValidIndex(PlayerID) ? Players[PlayerID].LargestRegion : 0;
+	}
+
+	// Dimensione della regione che contiene il territorio (0 se neutrale)
+	int32 GetRegionSize(int32 TerritoryID);
+
+private:
+	struct FPlayerRegions
+	{
+		// SizeHistogram[N] = numero di regioni con N territori
+		TArray<int32> SizeHistogram;
+		int32 LargestRegion = 0;
+	};
+
+	TArrayView<const int32> GetNeighbors(int32 TerritoryID) const
+	{
+		return MakeArrayView(AdjacencyIndices.GetData() + AdjacencyOffsets[TerritoryID],
+		                     AdjacencyOffsets[TerritoryID + 1] - AdjacencyOffsets[TerritoryID]);
+	}
+
+	int32 Find(int32 TerritoryID);
+	void Union(int32 TerritoryA, int32 TerritoryB);
+
+	void AddRegion(int32 PlayerID, int32 Size);
+	void RemoveRegion(int32 PlayerID, int32 Size);
+
+	// Ricalcola le componenti rimaste dopo la perdita di TerritoryID da parte di OldOwnerID
+	void SplitAfterLoss(int32 TerritoryID, int32 OldOwnerID);
+
+	TArray<int32> AdjacencyOffsets;
+	TArray<int32> AdjacencyIndices;
+
+	TArray<int32> Owner;   // Proprietario per territorio (-1 = neutrale)
+	TArray<int32> Parent;  // Union-find: genitore (== se stesso per le radici)
+	TArray<int32> Size;    // Dimensione della componente (valida solo sulle radici)
+
+	TArray<FPlayerRegions> Players;
+
+	// Scratch per la BFS dello split (riusato tra chiamate)
+	TArray<int32> VisitStamp;
+	int32 CurrentStamp = 0;
+	TArray<int32> Queue;
+	TArray<int32> Members;
+};
@@ -399,7 +399,7 @@ int32 UGameHUDWidget::CalculatePlayerTotalTroops(int32 PlayerID) const
 	int32 Total = 0;
 
 	// Somma truppe su tutti i territori del player
-	for (const FTerritoryGameState& Territory : GameState->Territories)
+	for (const FTerritoryGameState& Territory : GameState->Territories.Items)
 	{
 		if (Territory.OwnerID == PlayerID)
 		{
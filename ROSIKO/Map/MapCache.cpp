@@ -0,0 +1,283 @@
+#include "MapCache.h"
+#include "../Configs/MapGenerationConfig.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Hash/CityHash.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRosikoMapCache, Log, All);
+
+namespace MapCacheFormat
+{
+    static constexpr uint32 Magic = 0x50414D52; // 'RMAP'
+    static constexpr uint32 FormatVersion = 1;
+
+    struct FHeader
+    {
+        uint32 Magic = 0;
+        uint32 FormatVersion = 0;
+        uint32 GeneratorVersion = 0;
+        int32 Seed = 0;
+        uint64 ConfigHash = 0;
+        uint64 PayloadSize = 0;
+        uint32 PayloadCrc = 0;
+        uint32 Padding = 0;
+    };
+}
+
+uint64 FMapCache::HashConfiguration(const UMapGenerationConfig& Config, TArrayView<const uint32> MaskTexels, int32 MaskSizeX)
+{
+    // Serializziamo in un buffer solo i campi che cambiano il risultato della generazione
+    TArray<uint8> Bytes;
+    FMemoryWriter Writer(Bytes);
+
+    FVector2D MapSize = Config.MapSize;
+    int32 GridResolution = Config.GridResolution;
+    FLinearColor OceanColor = Config.OceanColor;
+    FVector2D TerritoryHeightRange = Config.TerritoryHeightRange;
+    FVector2D CellHeightRange = Config.CellHeightRange;
+    FVector2D TerritoryBrightnessRange = Config.TerritoryBrightnessRange;
+    float ContinentColorThreshold = Config.ContinentColorThreshold;
+    float HeightDifferenceThreshold = Config.HeightDifferenceThreshold;
+    uint8 VoronoiAlgorithm = (uint8)Config.VoronoiAlgorithm;
+    bool bUseGreedyMeshing = Config.bUseGreedyMeshing;
+    bool bWeldVertices = Config.bWeldVertices;
+
+    Writer << MapSize << GridResolution << OceanColor;
+    Writer << TerritoryHeightRange << CellHeightRange << TerritoryBrightnessRange;
+    Writer << ContinentColorThreshold << HeightDifferenceThreshold;
+    Writer << VoronoiAlgorithm << bUseGreedyMeshing << bWeldVertices;
+
+    for (const FContinentDefinition& Continent : Config.ContinentSetup)
+    {
+        FString Name = Continent.Name;
+        FLinearColor Color = Continent.Color;
+        int32 TerritoryCount = Continent.TerritoryCount;
+        float ColorTolerance = Continent.ColorTolerance;
+        TArray<FString> TerritoryNames = Continent.TerritoryNames;
+        Writer << Name << Color << TerritoryCount << ColorTolerance << TerritoryNames;
+    }
+
+    uint64 Hash = CityHash64((const char*)Bytes.GetData(), Bytes.Num());
+
+    // La maschera conta per contenuto, non per nome: un reimport con pixel diversi invalida la cache
+    Hash = CityHash64WithSeed((const char*)&MaskSizeX, sizeof(MaskSizeX), Hash);
+    Hash = CityHash64WithSeed((const char*)MaskTexels.GetData(), MaskTexels.Num() * sizeof(uint32), Hash);
+
+    return Hash;
+}
+
+FString FMapCache::GetCacheFilePath(const FKey& Key)
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("MapCache"),
+        FString::Printf(TEXT("Map_%d_%016llx_v%u.bin"), Key.Seed, Key.ConfigHash, Key.GeneratorVersion));
+}
+
+bool FMapCache::Load(const FKey& Key, TFunctionRef<bool(FArchive&)> ReadPayload)
+{
+    using namespace MapCacheFormat;
+
+    const FString Path = GetCacheFilePath(Key);
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.FileExists(*Path))
+    {
+        return false;
+    }
+
+    // Preferiamo il file mappato in memoria (niente copia del file intero); fallback su lettura completa
+    TUniquePtr<IMappedFileHandle> MappedHandle(PlatformFile.OpenMapped(*Path));
+    TUniquePtr<IMappedFileRegion> MappedRegion;
+    TArray<uint8> FileBytes;
+    TArrayView<const uint8> FileView;
+
+    if (MappedHandle)
+    {
+        MappedRegion.Reset(MappedHandle->MapRegion(0, MappedHandle->GetFileSize()));
+    }
+
+    if (MappedRegion)
+    {
+        FileView = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), (int32)MappedRegion->GetMappedSize());
+    }
+    else if (FFileHelper::LoadFileToArray(FileBytes, *Path))
+    {
+        FileView = FileBytes;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (FileView.Num() < (int32)sizeof(FHeader))
+    {
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Map cache %s is truncated, ignoring"), *Path);
+        return false;
+    }
+
+    FHeader Header;
+    FMemory::Memcpy(&Header, FileView.GetData(), sizeof(FHeader));
+
+    const bool bHeaderMatches = Header.Magic == Magic
+        && Header.FormatVersion == FormatVersion
+        && Header.GeneratorVersion == Key.GeneratorVersion
+        && Header.Seed == Key.Seed
+        && Header.ConfigHash == Key.ConfigHash
+        && Header.PayloadSize == (uint64)FileView.Num() - sizeof(FHeader);
+    if (!bHeaderMatches)
+    {
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Map cache %s has a mismatched header, ignoring"), *Path);
+        return false;
+    }
+
+    TArrayView<const uint8> Payload = FileView.Slice((int32)sizeof(FHeader), (int32)Header.PayloadSize);
+    if (FCrc::MemCrc32(Payload.GetData(), Payload.Num()) != Header.PayloadCrc)
+    {
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Map cache %s failed CRC check, ignoring"), *Path);
+        return false;
+    }
+
+    FMemoryReaderView Reader(Payload);
+    if (!ReadPayload(Reader) || Reader.IsError() || !Reader.AtEnd())
+    {
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Map cache %s payload could not be read, ignoring"), *Path);
+        return false;
+    }
+
+    return true;
+}
+
+bool FMapCache::Save(const FKey& Key, TFunctionRef<bool(FArchive&)> WritePayload)
+{
+    using namespace MapCacheFormat;
+
+    TArray<uint8> FileBytes;
+    FileBytes.AddZeroed(sizeof(FHeader));
+
+    FMemoryWriter Writer(FileBytes);
+    Writer.Seek(sizeof(FHeader));
+    if (!WritePayload(Writer) || Writer.IsError())
+    {
+        // Payload incompleto: meglio nessun file che un file troncato con CRC valido
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Map cache payload for seed %d could not be written, skipping save"), Key.Seed);
+        return false;
+    }
+
+    FHeader Header;
+    Header.Magic = Magic;
+    Header.FormatVersion = FormatVersion;
+    Header.GeneratorVersion = Key.GeneratorVersion;
+    Header.Seed = Key.Seed;
+    Header.ConfigHash = Key.ConfigHash;
+    Header.PayloadSize = FileBytes.Num() - sizeof(FHeader);
+    Header.PayloadCrc = FCrc::MemCrc32(FileBytes.GetData() + sizeof(FHeader), (int32)Header.PayloadSize);
+    FMemory::Memcpy(FileBytes.GetData(), &Header, sizeof(FHeader));
+
+    // Scrittura su file temporaneo + rename: un crash a metà non lascia un file valido per metà.
+    // Nome temporaneo univoco: in PIE server e client nello stesso processo possono salvare lo stesso seed in parallelo
+    const FString Path = GetCacheFilePath(Key);
+    const FString TempPath = FPaths::CreateTempFilename(*FPaths::GetPath(Path), *FPaths::GetBaseFilename(Path), TEXT(".tmp"));
+    if (!FFileHelper::SaveArrayToFile(FileBytes, *TempPath))
+    {
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Could not write map cache %s"), *TempPath);
+        return false;
+    }
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.DeleteFile(*Path);
+    if (!PlatformFile.MoveFile(*Path, *TempPath))
+    {
+        PlatformFile.DeleteFile(*TempPath);
+        UE_LOG(LogRosikoMapCache, Warning, TEXT("Could not move map cache into place: %s"), *Path);
+        return false;
+    }
+
+    UE_LOG(LogRosikoMapCache, Log, TEXT("Map cache saved: %s (%.1f KB)"), *Path, FileBytes.Num() / 1024.0);
+
+    Prune(Key.GeneratorVersion, Path);
+    return true;
+}
+
+void FMapCache::Prune(uint32 CurrentGeneratorVersion, const FString& KeepPath)
+{
+    struct FCacheFile
+    {
+        FString Path;
+        FDateTime ModificationTime;
+        int64 Size = 0;
+    };
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const FString Directory = FPaths::GetPath(KeepPath);
+    const FString VersionSuffix = FString::Printf(TEXT("_v%u.bin"), CurrentGeneratorVersion);
+
+    // Temporanei più vecchi di così sono scritture interrotte (crash), non salvataggi in corso
+    const FDateTime StaleTempTime = FDateTime::UtcNow() - FTimespan::FromHours(1.0);
+
+    TArray<FCacheFile> Files;
+    TArray<FString> ToDelete;
+
+    PlatformFile.IterateDirectoryStat(*Directory, [&](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+    {
+        if (StatData.bIsDirectory)
+        {
+            return true;
+        }
+
+        const FString FilePath(FilenameOrDirectory);
+        const FString Filename = FPaths::GetCleanFilename(FilePath);
+        if (!Filename.StartsWith(TEXT("Map_")))
+        {
+            return true;
+        }
+
+        if (Filename.EndsWith(TEXT(".tmp")))
+        {
+            if (StatData.ModificationTime < StaleTempTime)
+            {
+                ToDelete.Add(FilePath);
+            }
+        }
+        else if (Filename.EndsWith(TEXT(".bin")))
+        {
+            if (!Filename.EndsWith(VersionSuffix))
+            {
+                ToDelete.Add(FilePath); // Versione del generatore diversa: non verrà mai più letto
+            }
+            else if (!FPaths::IsSamePath(FilePath, KeepPath))
+            {
+                Files.Add({ FilePath, StatData.ModificationTime, StatData.FileSize });
+            }
+        }
+        return true;
+    });
+
+    // Dal più recente al più vecchio: si tengono i primi finché restano nei limiti (il file appena scritto conta già)
+    Files.Sort([](const FCacheFile& A, const FCacheFile& B) { return A.ModificationTime > B.ModificationTime; });
+
+    int32 KeptFiles = 1;
+    int64 KeptBytes = FMath::Max<int64>(PlatformFile.FileSize(*KeepPath), 0);
+    for (const FCacheFile& File : Files)
+    {
+        if (KeptFiles < MaxCachedFiles && KeptBytes + File.Size <= MaxCacheBytes)
+        {
+            KeptFiles++;
+            KeptBytes += File.Size;
+        }
+        else
+        {
+            ToDelete.Add(File.Path);
+        }
+    }
+
+    for (const FString& FilePath : ToDelete)
+    {
+        // Un altro processo/istanza può averlo già rimosso: errore ignorato
+        if (PlatformFile.DeleteFile(*FilePath))
+        {
+            UE_LOG(LogRosikoMapCache, Log, TEXT("Map cache pruned: %s"), *FilePath);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UMapGenerationConfig;
+
+/**
+ * Cache su disco delle mappe generate (Saved/MapCache).
+ * Chiave = (seed, hash del contenuto della config, versione del generatore): se una delle tre cambia
+ * il file non viene più trovato/accettato e la mappa si rigenera.
+ *
+ * Formato: header fisso + payload binario scritto dal generatore (piani della griglia, metadati, mesh).
+ * Il file viene letto con OpenMapped (fallback: lettura completa) e il payload è verificato con CRC32
+ * prima di essere deserializzato.
+ *
+ * Dopo ogni salvataggio la cartella viene potata: file di altre versioni del generatore, temporanei
+ * orfani e, oltre MaxCachedFiles / MaxCacheBytes, i file meno recenti.
+ */
+class ROSIKO_API FMapCache
+{
+public:
+    struct FKey
+    {
+        int32 Seed = 0;
+        uint64 ConfigHash = 0;
+        uint32 GeneratorVersion = 0;
+    };
+
+    // Hash del contenuto della config (tutti i campi che influenzano l'output) + pixel della GenerationMask,
+    // presi dallo snapshot già fatto dal generatore (niente secondo lock della texture)
+    static uint64 HashConfiguration(const UMapGenerationConfig& Config, TArrayView<const uint32> MaskTexels, int32 MaskSizeX);
+
+    // Saved/MapCache/Map_<Seed>_<Hash>_v<Version>.bin
+    static FString GetCacheFilePath(const FKey& Key);
+
+    // Legge e valida il file; ReadPayload deserializza il payload (ritorna false se incompleto/corrotto)
+    static bool Load(const FKey& Key, TFunctionRef<bool(FArchive&)> ReadPayload);
+
+    // Scrive header + payload prodotto da WritePayload (se ritorna false non scrive nulla)
+    static bool Save(const FKey& Key, TFunctionRef<bool(FArchive&)> WritePayload);
+
+    // Limiti della cartella cache (applicati da Prune)
+    static constexpr int32 MaxCachedFiles = 16;
+    static constexpr int64 MaxCacheBytes = 256ll * 1024 * 1024;
+
+    // Elimina file di versioni diverse da CurrentGeneratorVersion, temporanei orfani e i file più vecchi
+    // oltre i limiti. KeepPath (il file appena scritto) non viene mai eliminato.
+    static void Prune(uint32 CurrentGeneratorVersion, const FString& KeepPath);
+
+    // Array POD come blocco di byte contiguo (count + memcpy), senza serializzazione per elemento.
+    // In lettura rifiuta count negativi o più grandi dei byte rimasti.
+    template <typename T>
+    static void SerializeRawArray(FArchive& Ar, TArray<T>& Array)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SerializeRawArray requires a trivially copyable element type");
+
+        int32 Num = Array.Num();
+        Ar << Num;
+
+        if (Ar.IsLoading())
+        {
+            if (Num < 0 || (int64)Num * (int64)sizeof(T) > Ar.TotalSize() - Ar.Tell())
+            {
+                Ar.SetError();
+                return;
+            }
+            Array.SetNumUninitialized(Num);
+        }
+
+        Ar.Serialize(Array.GetData(), (int64)Num * sizeof(T));
+    }
+};
@@ -6,7 +6,40 @@
 
 
 /**
- * Contiene i dati puri matematici di un territorio generato.
+ * Geometria di un territorio (local space, relativa a CenterPoint).
+ * Vive solo tra la generazione e l'upload nella ProceduralMeshComponent del TerritoryActor,
+ * poi viene liberata: la mesh resta solo nella sezione della PMC.
+ */
+USTRUCT(BlueprintType)
+struct FGeneratedTerritoryMesh
+{
+    GENERATED_BODY()
+
+    // I vertici della mesh voxel del territorio
+    UPROPERTY(BlueprintReadOnly)
+    TArray<FVector> Vertices;
+
+    // Indici dei triangoli
+    UPROPERTY(BlueprintReadOnly)
+    TArray<int32> Triangles;
+
+    // Normali dei vertici (per shading corretto)
+    UPROPERTY(BlueprintReadOnly)
+    TArray<FVector> Normals;
+
+    // Colori dei vertici (per colorare la mesh procedurale)
+    UPROPERTY(BlueprintReadOnly)
+    TArray<FLinearColor> VertexColors;
+
+    SIZE_T GetAllocatedSize() const
+    {
+        return Vertices.GetAllocatedSize() + Triangles.GetAllocatedSize() + Normals.GetAllocatedSize() + VertexColors.GetAllocatedSize();
+    }
+};
+
+/**
+ * Contiene i dati puri matematici di un territorio generato (metadati statici + stato di gioco).
+ * La geometria sta a parte in FGeneratedTerritoryMesh, così le copie di questa struct restano leggere.
  */
 USTRUCT(BlueprintType)
 struct FGeneratedTerritory
@@ -37,23 +70,6 @@ struct FGeneratedTerritory
     UPROPERTY(BlueprintReadOnly)
     FLinearColor TerritoryColor;
 
-    // I vertici che formano il perimetro del territorio (per disegnare la mesh)
-    UPROPERTY(BlueprintReadOnly)
-    TArray<FVector> Vertices;
-
-    // Indici dei triangoli (opzionale, se generati dal C++)
-    // Se popolato, passare questo a "Create Mesh Section" invece di usare algoritmi custom nel BP.
-    UPROPERTY(BlueprintReadOnly)
-    TArray<int32> Triangles;
-
-    // Normali dei vertici (opzionale, per shading corretto)
-    UPROPERTY(BlueprintReadOnly)
-    TArray<FVector> Normals;
-
-    // Colori dei vertici (per colorare la mesh procedurale)
-    UPROPERTY(BlueprintReadOnly)
-    TArray<FLinearColor> VertexColors;
-
     // ID dei territori confinanti (per la logica di movimento/attacco)
     UPROPERTY(BlueprintReadOnly)
     TArray<int32> NeighborIDs;
@@ -80,3 +96,50 @@ struct FGeneratedTerritory
     UPROPERTY(BlueprintReadOnly)
     int32 ContinentID = -1;
 };
+
+/**
+ * Tempi per stage (ms) e dimensioni dell'ultima generazione.
+ * Riempiti sia dalla generazione sincrona che da quella asincrona (usati dal benchmark commandlet).
+ */
+USTRUCT(BlueprintType)
+struct FMapGenerationStats
+{
+    GENERATED_BODY()
+
+    // Mappa caricata dalla cache su disco (gli stage di generazione restano a 0)
+    UPROPERTY(BlueprintReadOnly)
+    bool bLoadedFromCache = false;
+
+    UPROPERTY(BlueprintReadOnly)
+    float PopulateMs = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly)
+    float SeedsMs = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly)
+    float VoronoiMs = 0.0f;
+
+    // Metadati + adiacenza + mesh
+    UPROPERTY(BlueprintReadOnly)
+    float GeometryMs = 0.0f;
+
+    // Spawn actor + upload mesh (game thread; in async è la somma dei frame)
+    UPROPERTY(BlueprintReadOnly)
+    float SpawnMs = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly)
+    float TotalMs = 0.0f;
+
+    UPROPERTY(BlueprintReadOnly)
+    int32 NumTerritories = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int32 TotalVertices = 0;
+
+    UPROPERTY(BlueprintReadOnly)
+    int32 TotalTriangles = 0;
+
+    // Memoria allocata dai piani della griglia
+    UPROPERTY(BlueprintReadOnly)
+    float GridMemoryKB = 0.0f;
+};
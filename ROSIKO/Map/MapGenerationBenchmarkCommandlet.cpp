@@ -0,0 +1,143 @@
+#include "MapGenerationBenchmarkCommandlet.h"
+#include "MapGenerator.h"
+#include "../Configs/MapGenerationConfig.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRosikoMapBenchmark, Log, All);
+
+namespace
+{
+    // "1,2,3" -> {1,2,3}; valore assente -> Default
+    TArray<int32> ParseIntList(const TMap<FString, FString>& ParamVals, const TCHAR* Key, int32 Default)
+    {
+        TArray<int32> Values;
+        if (const FString* Value = ParamVals.Find(Key))
+        {
+            TArray<FString> Parts;
+            Value->ParseIntoArray(Parts, TEXT(","));
+            for (const FString& Part : Parts)
+            {
+                Values.Add(FCString::Atoi(*Part));
+            }
+        }
+
+        if (Values.Num() == 0)
+        {
+            Values.Add(Default);
+        }
+        return Values;
+    }
+}
+
+UMapGenerationBenchmarkCommandlet::UMapGenerationBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsEditor = false;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UMapGenerationBenchmarkCommandlet::Main(const FString& Params)
+{
+    TArray<FString> Tokens;
+    TArray<FString> Switches;
+    TMap<FString, FString> ParamVals;
+    ParseCommandLine(*Params, Tokens, Switches, ParamVals);
+
+    const FString* ConfigPath = ParamVals.Find(TEXT("Config"));
+    UMapGenerationConfig* BaseConfig = ConfigPath ? LoadObject<UMapGenerationConfig>(nullptr, **ConfigPath) : nullptr;
+    if (!BaseConfig || !BaseConfig->GenerationMask)
+    {
+        UE_LOG(LogRosikoMapBenchmark, Error, TEXT("Missing or invalid -Config=<UMapGenerationConfig path> (needs a GenerationMask)"));
+        return 1;
+    }
+
+    const TArray<int32> Seeds = ParseIntList(ParamVals, TEXT("Seeds"), 12345);
+    const TArray<int32> Resolutions = ParseIntList(ParamVals, TEXT("Resolutions"), BaseConfig->GridResolution);
+    const TArray<int32> ContinentCounts = ParseIntList(ParamVals, TEXT("Continents"), BaseConfig->ContinentSetup.Num());
+    const int32 Repeat = FMath::Max(1, ParseIntList(ParamVals, TEXT("Repeat"), 1)[0]);
+
+    FString OutputPath;
+    if (const FString* Output = ParamVals.Find(TEXT("Output")))
+    {
+        OutputPath = *Output;
+    }
+    else
+    {
+        OutputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Benchmarks"),
+            FString::Printf(TEXT("MapGeneration_%s.csv"), *FDateTime::Now().ToString()));
+    }
+
+    // Mondo di gioco temporaneo: serve solo per spawnare generatore e territori
+    UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("MapGenerationBenchmark"));
+    FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+    WorldContext.SetCurrentWorld(World);
+
+    FString Csv = TEXT("Seed,GridResolution,Continents,Run,Territories,PopulateMs,SeedsMs,VoronoiMs,GeometryMs,SpawnMs,TotalMs,Vertices,Triangles,GridMemoryKB,UsedPhysicalMB,UsedPhysicalDeltaMB\n");
+
+    for (int32 Resolution : Resolutions)
+    {
+        for (int32 ContinentCount : ContinentCounts)
+        {
+            // Copia della config per ogni combinazione: l'asset originale non viene toccato
+            UMapGenerationConfig* Config = DuplicateObject<UMapGenerationConfig>(BaseConfig, GetTransientPackage());
+            Config->GridResolution = Resolution;
+            Config->ContinentSetup.SetNum(FMath::Clamp(ContinentCount, 1, BaseConfig->ContinentSetup.Num()));
+            Config->bUseMapCache = false;
+            Config->bShowDebugGlobals = false;
+            Config->bShowDebugPlane = false;
+
+            for (int32 Seed : Seeds)
+            {
+                for (int32 Run = 0; Run < Repeat; Run++)
+                {
+                    AMapGenerator* Generator = World->SpawnActor<AMapGenerator>();
+                    Generator->Configuration = Config;
+                    Generator->MapSeed = Seed;
+                    Generator->bAllowLogicOnlyGeneration = false; // -nullrhi: vogliamo misurare anche geometria e spawn
+
+                    // Memoria per singola esecuzione: il picco di processo resterebbe fermo al caso più grande già eseguito
+                    const uint64 UsedPhysicalBefore = FPlatformMemory::GetStats().UsedPhysical;
+                    Generator->GenerateMap();
+
+                    const FMapGenerationStats& Stats = Generator->GetLastGenerationStats();
+                    const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+                    const double UsedPhysicalDeltaMB = ((double)MemoryStats.UsedPhysical - (double)UsedPhysicalBefore) / (1024.0 * 1024.0);
+
+                    Csv += FString::Printf(TEXT("%d,%d,%d,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%.1f,%.1f,%.1f\n"),
+                        Seed, Resolution, Config->ContinentSetup.Num(), Run, Stats.NumTerritories,
+                        Stats.PopulateMs, Stats.SeedsMs, Stats.VoronoiMs, Stats.GeometryMs, Stats.SpawnMs, Stats.TotalMs,
+                        Stats.TotalVertices, Stats.TotalTriangles, Stats.GridMemoryKB,
+                        MemoryStats.UsedPhysical / (1024.0 * 1024.0), UsedPhysicalDeltaMB);
+
+                    UE_LOG(LogRosikoMapBenchmark, Display, TEXT("Seed %d | Res %d | Continents %d | Run %d: %.2f ms total (%d territories, %d triangles)"),
+                        Seed, Resolution, Config->ContinentSetup.Num(), Run, Stats.TotalMs, Stats.NumTerritories, Stats.TotalTriangles);
+
+                    Generator->ClearMap();
+                    Generator->Destroy();
+                }
+            }
+
+            // Libera generatori, territori e mesh prima della combinazione successiva
+            CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+        }
+    }
+
+    GEngine->DestroyWorldContext(World);
+    World->DestroyWorld(false);
+
+    if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+    {
+        UE_LOG(LogRosikoMapBenchmark, Error, TEXT("Could not write benchmark CSV: %s"), *OutputPath);
+        return 1;
+    }
+
+    UE_LOG(LogRosikoMapBenchmark, Display, TEXT("Benchmark results written to %s"), *OutputPath);
+    return 0;
+}
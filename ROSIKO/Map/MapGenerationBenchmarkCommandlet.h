@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MapGenerationBenchmarkCommandlet.generated.h"
+
+/**
+ * Benchmark della generazione mappa: esegue AMapGenerator (percorso sincrono, cache disattivata)
+ * su una matrice seed x GridResolution x numero continenti e scrive un CSV con i tempi per stage
+ * (populate, seeds, voronoi, geometry, spawn), memoria e conteggio vertici/triangoli.
+ *
+ * Uso:
+ *   UnrealEditor-Cmd ROSIKO.uproject -run=MapGenerationBenchmark -nullrhi -unattended
+ *       -Config=/Game/Path/DA_MapConfig.DA_MapConfig
+ *       [-Seeds=1,2,3] [-Resolutions=200,400] [-Continents=3,6] [-Repeat=3] [-Output=Path.csv]
+ *
+ * Continents=N usa i primi N continenti di ContinentSetup (le celle degli altri diventano oceano).
+ * Senza -Output il CSV va in Saved/Benchmarks/MapGeneration_<data>.csv.
+ */
+UCLASS()
+class ROSIKO_API UMapGenerationBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UMapGenerationBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -1,12 +1,54 @@
 #include "MapGenerator.h"
+#include "../ROSIKO.h"
 #include "./Territory/TerritoryActor.h"
+#include "./Territory/TerritoryRegistrySubsystem.h"
 #include "../Configs/MapGenerationConfig.h"
+#include "MapCache.h"
 #include "Net/UnrealNetwork.h"
 #include "DrawDebugHelpers.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/App.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Algo/Unique.h"
+#include "Hash/CityHash.h"
 
 // Log category per MapGenerator
 DEFINE_LOG_CATEGORY_STATIC(LogRosikoMapGen, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("MapGen Sync Generate"), STAT_RosikoMapGenSync, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Async Pipeline"), STAT_RosikoMapGenPipeline, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Mask Snapshot"), STAT_RosikoMapGenMaskSnapshot, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Continent LUT"), STAT_RosikoMapGenContinentLUT, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Populate Grid"), STAT_RosikoMapGenPopulate, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Seeds"), STAT_RosikoMapGenSeeds, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Voronoi"), STAT_RosikoMapGenVoronoi, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen JFA Init"), STAT_RosikoMapGenJumpFloodInit, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen JFA Pass"), STAT_RosikoMapGenJumpFloodPass, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Distance Transform"), STAT_RosikoMapGenDistanceTransform, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Assign Territories"), STAT_RosikoMapGenAssignTerritories, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Territory Metadata"), STAT_RosikoMapGenMetadata, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Adjacency"), STAT_RosikoMapGenAdjacency, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Geometry"), STAT_RosikoMapGenGeometry, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Cache Load"), STAT_RosikoMapGenCacheLoad, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Cache Save"), STAT_RosikoMapGenCacheSave, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Spawn Visuals"), STAT_RosikoMapGenSpawn, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Progress Broadcast"), STAT_RosikoMapGenProgressBroadcast, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("MapGen Debug Visuals"), STAT_RosikoMapGenDebugVisuals, STATGROUP_Rosiko);
+DECLARE_MEMORY_STAT(TEXT("MapGen Voxel Grid"), STAT_RosikoVoxelGridMemory, STATGROUP_Rosiko);
+DECLARE_MEMORY_STAT(TEXT("MapGen Territory Meshes"), STAT_RosikoTerritoryMeshMemory, STATGROUP_Rosiko);
+
+namespace
+{
+    // Millisecondi trascorsi da StartTime (FPlatformTime::Seconds)
+    float MillisecondsSince(double StartTime)
+    {
+        return (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+    }
+}
+
 AMapGenerator::AMapGenerator()
 {
 	PrimaryActorTick.bCanEverTick = true; // Abilitato per async generation
@@ -83,619 +125,1821 @@ void AMapGenerator::Tick(float DeltaTime)
 	}
 }
 
+void AMapGenerator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Il task non deve sopravvivere all'actor
+	StopGenerationTask();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+uint64 AMapGenerator::FTerritoryMeshBuilder::MakeVertexKey(int32 CornerX, int32 CornerY, int16 HeightQ, bool bGround, uint8 NormalIndex)
+{
+    // [CornerX:16][CornerY:16][HeightQ:16][Ground:1][Normal:3] - il colore è unico per territorio
+    return ((uint64)(uint16)CornerX << 36)
+        | ((uint64)(uint16)CornerY << 20)
+        | ((uint64)(uint16)(bGround ? 0 : HeightQ) << 4)
+        | ((uint64)(bGround ? 1 : 0) << 3)
+        | (uint64)(NormalIndex & 0x7);
+}
 
-void AMapGenerator::AddQuadFace(FGeneratedTerritory& Data, const FVector& V1, const FVector& V2, const FVector& Normal, const FLinearColor& Color)
+int32 AMapGenerator::FTerritoryMeshBuilder::AddVertex(int32 CornerX, int32 CornerY, int16 HeightQ, bool bGround, uint8 NormalIndex, const FVector& Normal)
 {
-    // Helper function to add a quad face (side face of voxel)
-    // V1 = top-left corner, V2 = bottom-right corner of the quad
-    // Generates 4 vertices forming a quad from V1 (top) to V2 (bottom) with ground projection
+    int32* Existing = nullptr;
+    uint64 Key = 0;
+    if (bWeldVertices)
+    {
+        Key = MakeVertexKey(CornerX, CornerY, HeightQ, bGround, NormalIndex);
+        Existing = VertexLookup.Find(Key);
+        if (Existing) return *Existing;
+    }
 
-    int32 SideIdx = Data.Vertices.Num();
+    // Vertici in LOCAL space (relativi al centro del territorio); le basi laterali stanno a Z locale 0
+    const FVector Position(
+        Origin.X + (float)CornerX * CellSize.X - Territory.CenterPoint.X,
+        Origin.Y + (float)CornerY * CellSize.Y - Territory.CenterPoint.Y,
+        bGround ? 0.0f : FVoxelGrid::DequantizeHeight(HeightQ) - Territory.CenterPoint.Z);
 
-    FVector V1_Ground = V1; V1_Ground.Z = 0;
-    FVector V2_Ground = V2; V2_Ground.Z = 0;
+    const int32 Index = Mesh.Vertices.Add(Position);
+    Mesh.Normals.Add(Normal);
+    Mesh.VertexColors.Add(Territory.TerritoryColor);
+
+    if (bWeldVertices)
+    {
+        VertexLookup.Add(Key, Index);
+    }
+    return Index;
+}
 
-    // Add 4 vertices: V1(top), V1_Ground(bottom), V2(top), V2_Ground(bottom)
-    Data.Vertices.Add(V1);
-    Data.Vertices.Add(V1_Ground);
-    Data.Vertices.Add(V2);
-    Data.Vertices.Add(V2_Ground);
+void AMapGenerator::FTerritoryMeshBuilder::AddTopFace(int32 CornerX0, int32 CornerY0, int32 CornerX1, int32 CornerY1, int16 HeightQ)
+{
+    // Faccia superiore da corner (X0,Y0) a (X1,Y1):
+    //   TL -- TR
+    //   |      |
+    //   BL -- BR
+    static const FVector UpNormal(0, 0, 1);
+    const int32 TL = AddVertex(CornerX0, CornerY0, HeightQ, false, 0, UpNormal);
+    const int32 TR = AddVertex(CornerX1, CornerY0, HeightQ, false, 0, UpNormal);
+    const int32 BR = AddVertex(CornerX1, CornerY1, HeightQ, false, 0, UpNormal);
+    const int32 BL = AddVertex(CornerX0, CornerY1, HeightQ, false, 0, UpNormal);
+
+    // Triangle 1: TL-BR-TR (inverted winding)
+    Mesh.Triangles.Add(TL);
+    Mesh.Triangles.Add(BR);
+    Mesh.Triangles.Add(TR);
+
+    // Triangle 2: TL-BL-BR (inverted winding)
+    Mesh.Triangles.Add(TL);
+    Mesh.Triangles.Add(BL);
+    Mesh.Triangles.Add(BR);
+}
 
-    // Add normals (all same direction)
-    Data.Normals.Add(Normal);
-    Data.Normals.Add(Normal);
-    Data.Normals.Add(Normal);
-    Data.Normals.Add(Normal);
+void AMapGenerator::FTerritoryMeshBuilder::AddSideFace(int32 CornerX1, int32 CornerY1, int32 CornerX2, int32 CornerY2, int16 HeightQ, uint8 NormalIndex)
+{
+    // Faccia laterale: spigolo superiore da corner 1 a corner 2, proiettato fino a terra
+    static const FVector SideNormals[5] = { FVector(0,0,1), FVector(1,0,0), FVector(-1,0,0), FVector(0,-1,0), FVector(0,1,0) };
+    const FVector& Normal = SideNormals[NormalIndex];
 
-    // Add vertex colors
-    Data.VertexColors.Add(Color);
-    Data.VertexColors.Add(Color);
-    Data.VertexColors.Add(Color);
-    Data.VertexColors.Add(Color);
+    const int32 V1 = AddVertex(CornerX1, CornerY1, HeightQ, false, NormalIndex, Normal);
+    const int32 V1Ground = AddVertex(CornerX1, CornerY1, HeightQ, true, NormalIndex, Normal);
+    const int32 V2 = AddVertex(CornerX2, CornerY2, HeightQ, false, NormalIndex, Normal);
+    const int32 V2Ground = AddVertex(CornerX2, CornerY2, HeightQ, true, NormalIndex, Normal);
 
     // Add triangles (2 triangles forming quad)
-    Data.Triangles.Add(SideIdx + 0);
-    Data.Triangles.Add(SideIdx + 2);
-    Data.Triangles.Add(SideIdx + 1);
+    Mesh.Triangles.Add(V1);
+    Mesh.Triangles.Add(V2);
+    Mesh.Triangles.Add(V1Ground);
 
-    Data.Triangles.Add(SideIdx + 2);
-    Data.Triangles.Add(SideIdx + 3);
-    Data.Triangles.Add(SideIdx + 1);
+    Mesh.Triangles.Add(V2);
+    Mesh.Triangles.Add(V2Ground);
+    Mesh.Triangles.Add(V1Ground);
 }
 
+int32 AMapGenerator::FContinentClassifier::Classify(uint8 R8, uint8 G8, uint8 B8) const
+{
+    const FLinearColor Sample(R8 / 255.0f, G8 / 255.0f, B8 / 255.0f, 1.0f);
+    const FVector SampleVec(Sample.R, Sample.G, Sample.B);
+
+    // 3.0 Explicit Ocean Checks
+    // A. Config Ocean, B. Auto-Detected Ocean
+    float DistConfigOcean = FVector::Dist(SampleVec, ConfigOcean);
+    float DistAutoOcean = FVector::Dist(SampleVec, AutoOcean);
 
+    // C. Hardcoded Common Backgrounds (Black / White)
+    // Fixes issues where top-left is White but inner sea is Black (or vice versa).
+    bool bIsBlack = (Sample.R < 0.15f && Sample.G < 0.15f && Sample.B < 0.15f);
+    bool bIsWhite = (Sample.R > 0.85f && Sample.G > 0.85f && Sample.B > 0.85f);
 
-void AMapGenerator::GenerateMap()
+    // If match any, SKIP
+    if (DistConfigOcean < OceanDistance || DistAutoOcean < OceanDistance || bIsBlack || bIsWhite)
+    {
+        return -1;
+    }
+
+    // FIND BEST MATCHING CONTINENT
+    int32 BestCont = -1;
+    float MinDistSq = FLT_MAX;
+
+    for (int32 c = 0; c < ContinentColors.Num(); c++)
+    {
+        float DistSq = FVector::DistSquared(SampleVec, ContinentColors[c]);
+        if (DistSq < MinDistSq && DistSq < AcceptanceThresholdSq)
+        {
+            MinDistSq = DistSq;
+            BestCont = c;
+        }
+    }
+
+    return BestCont;
+}
+
+int32 AMapGenerator::FContinentClassifier::ClassifyBox(const FIntVector& Lo, const FIntVector& Hi) const
 {
-    // Start timing
-    double StartTime = FPlatformTime::Seconds();
+    // Classificazione conservativa di un intero box RGB (estremi inclusi, in byte).
+    // Ritorna un codice solo se TUTTI i colori del box danno lo stesso risultato di Classify,
+    // altrimenti Ambiguous. EPSILON copre gli arrotondamenti float/double vicino alle soglie.
+    constexpr double EPSILON = 1e-5;
 
-    // New Voxel Entry Point
-    // Use a fixed high resolution for now (e.g., 200xAspectRatio) or exposed config
-    // New Voxel Entry Point
-    int32 BaseResolution = (Configuration) ? Configuration->GridResolution : 200;
+    const FVector BoxMin(Lo.X / 255.0f, Lo.Y / 255.0f, Lo.Z / 255.0f);
+    const FVector BoxMax(Hi.X / 255.0f, Hi.Y / 255.0f, Hi.Z / 255.0f);
 
-    // Auto-adjust Aspect Ratio Logic first
-    if (Configuration && Configuration->GenerationMask)
+    auto MinDistSq = [&](const FVector& P)
     {
-        int32 W = Configuration->GenerationMask->GetSizeX();
-        int32 H = Configuration->GenerationMask->GetSizeY();
-        if (W > 0 && H > 0)
+        return FMath::Square(FMath::Clamp(P.X, BoxMin.X, BoxMax.X) - P.X)
+            + FMath::Square(FMath::Clamp(P.Y, BoxMin.Y, BoxMax.Y) - P.Y)
+            + FMath::Square(FMath::Clamp(P.Z, BoxMin.Z, BoxMax.Z) - P.Z);
+    };
+    auto MaxDistSq = [&](const FVector& P)
+    {
+        return FMath::Max(FMath::Square(BoxMin.X - P.X), FMath::Square(BoxMax.X - P.X))
+            + FMath::Max(FMath::Square(BoxMin.Y - P.Y), FMath::Square(BoxMax.Y - P.Y))
+            + FMath::Max(FMath::Square(BoxMin.Z - P.Z), FMath::Square(BoxMax.Z - P.Z));
+    };
+
+    // I test nero/bianco sono per canale sugli stessi float del campione: esatti sugli estremi del box
+    const bool bAllBlack = BoxMax.X < 0.15f && BoxMax.Y < 0.15f && BoxMax.Z < 0.15f;
+    const bool bAllWhite = BoxMin.X > 0.85f && BoxMin.Y > 0.85f && BoxMin.Z > 0.85f;
+    const bool bAnyBlack = BoxMin.X < 0.15f && BoxMin.Y < 0.15f && BoxMin.Z < 0.15f;
+    const bool bAnyWhite = BoxMax.X > 0.85f && BoxMax.Y > 0.85f && BoxMax.Z > 0.85f;
+
+    const double OceanDistSq = FMath::Square((double)OceanDistance);
+    const bool bAllOcean = bAllBlack || bAllWhite
+        || MaxDistSq(ConfigOcean) < OceanDistSq - EPSILON
+        || MaxDistSq(AutoOcean) < OceanDistSq - EPSILON;
+    if (bAllOcean) return -1;
+
+    const bool bNoOcean = !bAnyBlack && !bAnyWhite
+        && MinDistSq(ConfigOcean) > OceanDistSq + EPSILON
+        && MinDistSq(AutoOcean) > OceanDistSq + EPSILON;
+    if (!bNoOcean) return Ambiguous;
+
+    // Continenti: candidato = qualche colore del box può stare sotto soglia
+    int32 Winner = -1;
+    double WinnerMaxDistSq = 0.0;
+    double BestOtherMinDistSq = DBL_MAX;
+    bool bAnyCandidate = false;
+
+    for (int32 c = 0; c < ContinentColors.Num(); c++)
+    {
+        const double CandMinDistSq = MinDistSq(ContinentColors[c]);
+        if (CandMinDistSq >= AcceptanceThresholdSq + EPSILON) continue; // Mai sotto soglia nel box
+        bAnyCandidate = true;
+
+        const double CandMaxDistSq = MaxDistSq(ContinentColors[c]);
+        if (Winner == -1 && CandMaxDistSq < AcceptanceThresholdSq - EPSILON)
         {
-            float AspectRatio = (float)H / (float)W;
-            float NewY = Configuration->MapSize.X * AspectRatio;
-            if (!FMath::IsNearlyEqual(Configuration->MapSize.Y, NewY, 1.0f))
-            {
-                Configuration->MapSize.Y = NewY;
-                UE_LOG(LogRosikoMapGen, Log, TEXT("AMapGenerator: Auto-Adjusted MapSize.Y to %f"), NewY);
-            }
+            // Primo continente sempre sotto soglia: possibile vincitore
+            Winner = c;
+            WinnerMaxDistSq = CandMaxDistSq;
+        }
+        else
+        {
+            BestOtherMinDistSq = FMath::Min(BestOtherMinDistSq, CandMinDistSq);
         }
     }
 
-    GenerateVoxels(BaseResolution);
+    if (!bAnyCandidate) return -1; // Nessun continente raggiungibile: sempre "nessuno"
 
-    // End timing and log
-    double EndTime = FPlatformTime::Seconds();
-    double TotalTime = EndTime - StartTime;
+    // Vincitore certo solo se è strettamente più vicino di ogni altro candidato per ogni colore del box
+    if (Winner != -1 && WinnerMaxDistSq < BestOtherMinDistSq - EPSILON)
+    {
+        return Winner;
+    }
 
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("========================================"));
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("SYNC map generation COMPLETE!"));
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("Total generation time: %.3f seconds (%.0f ms)"), TotalTime, TotalTime * 1000.0);
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("Seed: %d | Territories: %d"), MapSeed, GeneratedData.Num());
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("========================================"));
+    return Ambiguous;
 }
 
-void AMapGenerator::GenerateVoxels(int32 GridResolution)
+void AMapGenerator::UpdateContinentColorLUT(const FContinentClassifier& Classifier)
 {
-    if (!Configuration || !Configuration->GenerationMask)
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenContinentLUT);
+
+    // Chiave = tutto ciò che influenza la classificazione; la LUT si ricostruisce solo se cambia
+    TArray<uint8> KeyBytes;
+    KeyBytes.Append((const uint8*)Classifier.ContinentColors.GetData(), Classifier.ContinentColors.Num() * sizeof(FVector));
+    KeyBytes.Append((const uint8*)&Classifier.ConfigOcean, sizeof(FVector));
+    KeyBytes.Append((const uint8*)&Classifier.AutoOcean, sizeof(FVector));
+    KeyBytes.Append((const uint8*)&Classifier.AcceptanceThresholdSq, sizeof(float));
+    const uint64 Key = CityHash64((const char*)KeyBytes.GetData(), KeyBytes.Num());
+
+    if (ContinentColorLUT.Num() == 65536 && ContinentColorLUTKey == Key)
     {
-        UE_LOG(LogRosikoMapGen, Error, TEXT("Voxel Gen Aborted: Missing Config or Mask!"));
         return;
     }
 
-    ClearMap();
-    GeneratedData.Empty();
-    RNG.Initialize(MapSeed);
+    const double StartTime = FPlatformTime::Seconds();
+    ContinentColorLUT.SetNumUninitialized(65536);
 
-    // 1. Setup Grid Dimensions
-    GridSizeX = GridResolution;
-    // Aspect Ratio correction for Grid Y
-    float AspectRatio = Configuration->MapSize.Y / Configuration->MapSize.X;
-    GridSizeY = FMath::RoundToInt(GridResolution * AspectRatio);
+    // Ogni voce copre il box di colori 8-bit che cadono nello stesso bucket 5-6-5
+    ParallelFor(32, [&](int32 R5)
+    {
+        for (int32 G6 = 0; G6 < 64; G6++)
+        {
+            for (int32 B5 = 0; B5 < 32; B5++)
+            {
+                const FIntVector Lo(R5 << 3, G6 << 2, B5 << 3);
+                const FIntVector Hi(Lo.X | 7, Lo.Y | 3, Lo.Z | 7);
+                ContinentColorLUT[(R5 << 11) | (G6 << 5) | B5] = (int16)Classifier.ClassifyBox(Lo, Hi);
+            }
+        }
+    });
 
-    VoxelGrid.Empty();
-    // Use Init instead of AddZeroed to ensure defaults (-1) are respected!
-    VoxelGrid.Init(FVoxelCell(), GridSizeX * GridSizeY);
+    ContinentColorLUTKey = Key;
 
-    UE_LOG(LogRosikoMapGen, Log, TEXT("Initializing Voxel Grid: %d x %d"), GridSizeX, GridSizeY);
+    int32 NumAmbiguous = 0;
+    for (int16 Code : ContinentColorLUT)
+    {
+        if (Code == FContinentClassifier::Ambiguous) NumAmbiguous++;
+    }
 
-    // 2. Texture Sampling Access
-    FTexture2DMipMap* Mip = &Configuration->GenerationMask->GetPlatformData()->Mips[0];
-    const uint8* RawData = (const uint8*)Mip->BulkData.LockReadOnly();
-    int32 TexSizeX = Configuration->GenerationMask->GetSizeX();
-    int32 TexSizeY = Configuration->GenerationMask->GetSizeY();
-
-    auto GetColorAtUV = [&](float U, float V) -> FLinearColor {
-        int32 X = FMath::Clamp(FMath::RoundToInt(U * (TexSizeX - 1)), 0, TexSizeX - 1);
-        int32 Y = FMath::Clamp(FMath::RoundToInt(V * (TexSizeY - 1)), 0, TexSizeY - 1);
-        int32 Index = (Y * TexSizeX + X) * 4;
-        return FLinearColor(RawData[Index + 2] / 255.0f, RawData[Index + 1] / 255.0f, RawData[Index + 0] / 255.0f, 1.0f);
-    };
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Continent color LUT built in %.2f ms (%d/65536 buckets fall back to exact test)"),
+        (FPlatformTime::Seconds() - StartTime) * 1000.0, NumAmbiguous);
+}
 
-    // STATS FOR DEBUG
-    TArray<int32> CellsPerContinent;
-    CellsPerContinent.AddZeroed(Configuration->ContinentSetup.Num());
-    int32 TotalValidCells = 0;
+int32 AMapGenerator::PopulateGridContinents(TArray<int32>& OutCellsPerContinent)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenPopulate);
+
+    const int32 NumContinents = Configuration->ContinentSetup.Num();
+    OutCellsPerContinent.Reset();
+    OutCellsPerContinent.AddZeroed(NumContinents);
 
-    // 3. Populate Grid (Assign Continent IDs)
+    // Texture Sampling Access (snapshot preso sul game thread, qui possiamo essere su un worker)
+    const int32 TexSizeX = MaskSizeX;
+    const int32 TexSizeY = MaskSizeY;
+
+    if (MaskTexels.Num() == 0 || TexSizeX <= 0 || TexSizeY <= 0)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("PopulateGridContinents: no GenerationMask snapshot!"));
+        return 0;
+    }
+    const uint8* RawData = (const uint8*)MaskTexels.GetData();
 
     // AUTO-DETECT BACKGROUND (OCEAN) COLOR from Top-Left corner (0,0)
     // This fixes the issue where Black background (0,0,0) is equidistant to Red(1,0,0)/Green/Blue
     // and gets claimed by the first continent in the list (North America).
-    FLinearColor AutoOceanColor = FLinearColor::White; // Default
-    if (RawData && TexSizeX > 0 && TexSizeY > 0)
+    FLinearColor AutoOceanColor(RawData[2] / 255.0f, RawData[1] / 255.0f, RawData[0] / 255.0f, 1.0f);
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Auto-Detected Ocean Color from (0,0): %s"), *AutoOceanColor.ToString());
+
+    // Classificatore esatto + LUT 5-6-5 (ricostruita solo se cambiano colori/soglie)
+    FContinentClassifier Classifier;
+    Classifier.ContinentColors.Reserve(NumContinents);
+    for (const FContinentDefinition& Cont : Configuration->ContinentSetup)
     {
-        // Sample 0,0
-        AutoOceanColor = FLinearColor(RawData[2] / 255.0f, RawData[1] / 255.0f, RawData[0] / 255.0f, 1.0f);
-        UE_LOG(LogRosikoMapGen, Warning, TEXT("Auto-Detected Ocean Color from (0,0): %s"), *AutoOceanColor.ToString());
+        Classifier.ContinentColors.Add(FVector(Cont.Color.R, Cont.Color.G, Cont.Color.B));
     }
+    Classifier.ConfigOcean = FVector(Configuration->OceanColor.R, Configuration->OceanColor.G, Configuration->OceanColor.B);
+    Classifier.AutoOcean = FVector(AutoOceanColor.R, AutoOceanColor.G, AutoOceanColor.B);
+    Classifier.AcceptanceThresholdSq = Configuration->ContinentColorThreshold; // Strict Threshold for continent color matching
 
-    // OPTIMIZATION: Pre-cache color conversions to FVector (eliminates 30k+ conversions in loop)
-    TArray<FVector> ContinentColorsVec;
-    ContinentColorsVec.Reserve(Configuration->ContinentSetup.Num());
-    for(const FContinentDefinition& Cont : Configuration->ContinentSetup)
+    UpdateContinentColorLUT(Classifier);
+    const int16* ColorLUT = ContinentColorLUT.GetData();
+
+    // Coordinate texel precalcolate per colonna/riga (stesso arrotondamento del campionamento per UV)
+    TArray<int32> TexelColumn;
+    TexelColumn.SetNumUninitialized(GridSizeX);
+    for (int32 X = 0; X < GridSizeX; X++)
     {
-        ContinentColorsVec.Add(FVector(Cont.Color.R, Cont.Color.G, Cont.Color.B));
+        float U = (float)X / (float)GridSizeX;
+        TexelColumn[X] = FMath::Clamp(FMath::RoundToInt(U * (TexSizeX - 1)), 0, TexSizeX - 1);
     }
 
-    FVector ConfigOceanVec(Configuration->OceanColor.R, Configuration->OceanColor.G, Configuration->OceanColor.B);
-    FVector AutoOceanVec(AutoOceanColor.R, AutoOceanColor.G, AutoOceanColor.B);
-
+    TArray<int32> TexelRowStart;
+    TexelRowStart.SetNumUninitialized(GridSizeY);
     for (int32 Y = 0; Y < GridSizeY; Y++)
     {
-        for (int32 X = 0; X < GridSizeX; X++)
-        {
-            float U = (float)X / (float)GridSizeX;
-            float V = (float)Y / (float)GridSizeY;
-
-            FLinearColor Sample = GetColorAtUV(U, V);
-            FVoxelCell* Cell = GetCell(X, Y);
-
-            // 3.0 Explicit Ocean Checks
-
-            // OPTIMIZATION: Convert Sample once to FVector
-            FVector SampleVec(Sample.R, Sample.G, Sample.B);
-
-            // A. Check against Config Ocean
-            float DistConfigOcean = FVector::Dist(SampleVec, ConfigOceanVec);
+        float V = (float)Y / (float)GridSizeY;
+        TexelRowStart[Y] = FMath::Clamp(FMath::RoundToInt(V * (TexSizeY - 1)), 0, TexSizeY - 1) * TexSizeX;
+    }
 
-            // B. Check against Auto-Detected Ocean
-            float DistAutoOcean = FVector::Dist(SampleVec, AutoOceanVec);
+    // Texel BGRA8 letti come uint32 (un solo load per cella, little-endian: B nei bit bassi)
+    const uint32* Texels = MaskTexels.GetData();
 
-            // C. Hardcoded Common Backgrounds (Black / White / Transparent)
-            // Fixes issues where top-left is White but inner sea is Black (or vice versa).
-            bool bIsBlack = (Sample.R < 0.15f && Sample.G < 0.15f && Sample.B < 0.15f);
-            bool bIsWhite = (Sample.R > 0.85f && Sample.G > 0.85f && Sample.B > 0.85f);
-            bool bIsTransparent = (Sample.A < 0.2f); // Alpha check
+    // Ogni cella dipende solo dal proprio sample: dividiamo la griglia in bande di righe
+    // e le processiamo sul task graph. ~4 bande per worker bilanciano il carico senza
+    // rendere costoso il merge finale dei contatori.
+    const int32 NumBands = FMath::Clamp(FTaskGraphInterface::Get().GetNumWorkerThreads() * 4, 1, FMath::Max(GridSizeY, 1));
+    const int32 RowsPerBand = FMath::DivideAndRoundUp(GridSizeY, NumBands);
 
-            // If match any, SKIP
-            if (DistConfigOcean < 0.2f || DistAutoOcean < 0.2f || bIsBlack || bIsWhite || bIsTransparent)
-            {
-                Cell->ContinentIndex = -1;
-                continue;
-            }
+    // Contatori per banda (Band * NumContinents + c), niente atomics nel loop caldo
+    TArray<int32> BandCellCounts;
+    BandCellCounts.AddZeroed(NumBands * NumContinents);
 
-            // FIND BEST MATCHING CONTINENT
-            int32 BestCont = -1;
-            float MinDistSq = FLT_MAX;
+    ParallelFor(NumBands, [&](int32 Band)
+    {
+        const int32 RowStart = Band * RowsPerBand;
+        const int32 RowEnd = FMath::Min(RowStart + RowsPerBand, GridSizeY);
+        int32* BandCounts = BandCellCounts.GetData() + Band * NumContinents;
 
-            // Strict Threshold for continent color matching
-            float AcceptanceThresholdSq = Configuration->ContinentColorThreshold;
+        for (int32 Y = RowStart; Y < RowEnd; Y++)
+        {
+            const uint32* TexelRow = Texels + TexelRowStart[Y];
+            int16* ContinentRow = VoxelGrid.Continent.GetData() + Y * GridSizeX;
 
-            // Check against Continents (using pre-cached vectors)
-            for (int32 c = 0; c < ContinentColorsVec.Num(); c++)
+            for (int32 X = 0; X < GridSizeX; X++)
             {
-                float DistSq = FVector::DistSquared(SampleVec, ContinentColorsVec[c]);
+                const uint32 Texel = TexelRow[TexelColumn[X]];
+                const uint8 B = (uint8)(Texel);
+                const uint8 G = (uint8)(Texel >> 8);
+                const uint8 R = (uint8)(Texel >> 16);
+
+                // Una lookup; solo i bucket a cavallo di una soglia ricadono sul test esatto
+                int32 BestCont = ColorLUT[FContinentClassifier::ToIndex565(R, G, B)];
+                if (BestCont == FContinentClassifier::Ambiguous)
+                {
+                    BestCont = Classifier.Classify(R, G, B);
+                }
 
-                if (DistSq < MinDistSq && DistSq < AcceptanceThresholdSq)
+                if (BestCont >= 0)
                 {
-                    MinDistSq = DistSq;
-                    BestCont = c;
+                    ContinentRow[X] = (int16)BestCont;
+                    BandCounts[BestCont]++;
+                }
+                else
+                {
+                    ContinentRow[X] = -1; // Ocean / nessun continente entro soglia
                 }
             }
+        }
+    });
 
-            if (BestCont != -1)
-            {
-                Cell->ContinentIndex = BestCont;
-                CellsPerContinent[BestCont]++;
-                TotalValidCells++;
-            }
+    // Lo snapshot serve solo qui
+    MaskTexels.Empty();
+
+    // Merge dei contatori per banda
+    int32 TotalValidCells = 0;
+    for (int32 Band = 0; Band < NumBands; Band++)
+    {
+        for (int32 c = 0; c < NumContinents; c++)
+        {
+            const int32 Count = BandCellCounts[Band * NumContinents + c];
+            OutCellsPerContinent[c] += Count;
+            TotalValidCells += Count;
         }
     }
 
-    Mip->BulkData.Unlock();
+    return TotalValidCells;
+}
 
-    // 4. Territory Partitioning (Flood Fill or K-Means or Random Seeds?)
-    // User wants "Voxel Style" territories.
-    // If we just make "Continents", they will be huge.
-    // We need to split continents into Territories.
-    // SIMPLE APPROACH: Random Seeds + Voronoi ON GRID (Manhattan Distance).
+void AMapGenerator::InitJumpFlood(const TArray<FGridSeed>& Seeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenJumpFloodInit);
 
-    // A. Generate Seeds per Continent
-    TArray<FGridSeed> Seeds;
-    int32 GlobalID = 0;
+    const int32 NumCells = GridSizeX * GridSizeY;
+    VoxelGrid.SeedIndex.Init(INDEX_NONE, NumCells);
+    VoxelGrid.SeedIndexBack.Init(INDEX_NONE, NumCells);
 
-    for (int32 c = 0; c < Configuration->ContinentSetup.Num(); c++)
+    // Ogni seed punta a se stesso (indice nell'array Seeds, non puntatore)
+    for (int32 SeedIdx = 0; SeedIdx < Seeds.Num(); SeedIdx++)
     {
-        const FContinentDefinition& Cont = Configuration->ContinentSetup[c];
-        int32 TargetCount = Cont.TerritoryCount;
-
-        // Find all valid cells for this continent
-        TArray<int32> ValidIndices;
-        for(int32 i=0; i<VoxelGrid.Num(); i++)
+        const FGridSeed& S = Seeds[SeedIdx];
+        if (S.X >= 0 && S.X < GridSizeX && S.Y >= 0 && S.Y < GridSizeY)
         {
-            if (VoxelGrid[i].ContinentIndex == c) ValidIndices.Add(i);
+            VoxelGrid.SeedIndex[S.Y * GridSizeX + S.X] = SeedIdx;
         }
+    }
+}
 
-        if (ValidIndices.Num() == 0) continue;
-
-        // Pick Random Cells as Centers
-        for(int32 k=0; k<TargetCount; k++)
+void AMapGenerator::RunJumpFloodPass(const TArray<FGridSeed>& Seeds, int32 JumpSize)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenJumpFloodPass);
+
+    // Ping-pong: leggiamo SOLO da SeedIndex (stato del passo precedente) e scriviamo
+    // SOLO in SeedIndexBack. Nessuna cella vede valori già aggiornati nello stesso passo,
+    // quindi il risultato non dipende dall'ordine di scansione e le righe sono indipendenti.
+    // Il passo tocca solo i piani Continent (int16) e SeedIndex (int32): 6 byte per cella.
+    const int32* Front = VoxelGrid.SeedIndex.GetData();
+    int32* Back = VoxelGrid.SeedIndexBack.GetData();
+    const int16* Continent = VoxelGrid.Continent.GetData();
+    const FGridSeed* SeedData = Seeds.GetData();
+
+    ParallelFor(GridSizeY, [&](int32 Y)
+    {
+        for (int32 X = 0; X < GridSizeX; X++)
         {
-            if (ValidIndices.Num() == 0) break; // Should not happen unless tiny continent
+            const int32 CellIdx = Y * GridSizeX + X;
+            const int32 ContinentIndex = Continent[CellIdx];
+
+            int32 BestSeed = Front[CellIdx];
+            if (ContinentIndex == -1)
+            {
+                Back[CellIdx] = BestSeed; // Ocean/invalid: nessuna propagazione
+                continue;
+            }
+
+            float BestDistSq = FLT_MAX;
+            if (BestSeed != INDEX_NONE)
+            {
+                BestDistSq = (float)(FMath::Square(SeedData[BestSeed].X - X) + FMath::Square(SeedData[BestSeed].Y - Y));
+            }
+
+            // Check 9 positions at distance JumpSize (3x3 grid centered on current cell)
+            for (int32 DY = -1; DY <= 1; DY++)
+            {
+                const int32 CheckY = Y + DY * JumpSize;
+                if (CheckY < 0 || CheckY >= GridSizeY) continue;
+
+                for (int32 DX = -1; DX <= 1; DX++)
+                {
+                    const int32 CheckX = X + DX * JumpSize;
+                    if (CheckX < 0 || CheckX >= GridSizeX) continue;
+
+                    const int32 NeighborSeed = Front[CheckY * GridSizeX + CheckX];
+                    if (NeighborSeed == INDEX_NONE) continue;
 
-            int32 VisitIdx = RNG.RandRange(0, ValidIndices.Num()-1);
-            int32 CellIdx = ValidIndices[VisitIdx];
+                    const FGridSeed& Candidate = SeedData[NeighborSeed];
 
-            // Convert back to X,Y
-            int32 EX = CellIdx % GridSizeX;
-            int32 EY = CellIdx / GridSizeX;
+                    // IMPORTANT: Only propagate seeds within same continent
+                    if (Candidate.ContIndex != ContinentIndex) continue;
 
-            // Generate base height for this territory
-            float TerritoryBaseHeight = RNG.FRandRange(Configuration->TerritoryHeightRange.X, Configuration->TerritoryHeightRange.Y);
+                    const float DistSq = (float)(FMath::Square(Candidate.X - X) + FMath::Square(Candidate.Y - Y));
 
-            FGridSeed NewSeed;
-            NewSeed.ID = GlobalID++;
-            NewSeed.ContIndex = c;
-            NewSeed.X = EX;
-            NewSeed.Y = EY;
-            NewSeed.BaseHeight = TerritoryBaseHeight;
-            Seeds.Add(NewSeed);
+                    // If neighbor's seed is closer, adopt it
+                    if (DistSq < BestDistSq)
+                    {
+                        BestDistSq = DistSq;
+                        BestSeed = NeighborSeed;
+                    }
+                }
+            }
 
-            // Initial Assignment
-            GetCell(EX, EY)->TerritoryID = NewSeed.ID;
+            Back[CellIdx] = BestSeed;
         }
-    }
+    });
 
-    // B. Grow Territories using Jump Flood Algorithm (JFA) or Brute Force
-    double VoronoiStartTime = FPlatformTime::Seconds();
+    // Il buffer appena scritto diventa lo stato corrente per il prossimo passo
+    Swap(VoxelGrid.SeedIndex, VoxelGrid.SeedIndexBack);
+}
 
-    if (Configuration->bUseJumpFloodAlgorithm)
+void AMapGenerator::RunExactDistanceTransform(const TArray<FGridSeed>& Seeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenDistanceTransform);
+
+    // Feature transform euclideo esatto e separabile (Felzenszwalb-Huttenlocher):
+    // passo 1 per colonne (seed più vicino nella stessa colonna), passo 2 per righe
+    // (inviluppo inferiore delle parabole dy^2 + (x-q)^2). O(celle) per continente.
+    // Risultato in VoxelGrid.SeedIndex, SeedIndexBack è lo scratch del passo 1.
+    const int32 NumCells = GridSizeX * GridSizeY;
+    VoxelGrid.SeedIndex.Init(INDEX_NONE, NumCells);
+    VoxelGrid.SeedIndexBack.Init(INDEX_NONE, NumCells);
+
+    const int32 NumContinents = Configuration->ContinentSetup.Num();
+
+    // Bounding box per continente: ogni continente vede solo i propri seed,
+    // quindi il transform gira solo dentro il suo rettangolo
+    TArray<FIntRect> ContinentBounds;
+    ContinentBounds.Init(FIntRect(GridSizeX, GridSizeY, -1, -1), NumContinents);
+    for (int32 Y = 0; Y < GridSizeY; Y++)
     {
-        // JUMP FLOOD ALGORITHM: O(N log N) instead of O(N*M)
-        // JFA propagates nearest seed information through "jumps" of decreasing size
-        UE_LOG(LogRosikoMapGen, Log, TEXT("Using Jump Flood Algorithm for Voronoi"));
+        for (int32 X = 0; X < GridSizeX; X++)
+        {
+            const int32 ContinentIndex = VoxelGrid.Continent[Y * GridSizeX + X];
+            if (ContinentIndex == -1) continue;
+
+            FIntRect& Bounds = ContinentBounds[ContinentIndex];
+            Bounds.Min.X = FMath::Min(Bounds.Min.X, X);
+            Bounds.Min.Y = FMath::Min(Bounds.Min.Y, Y);
+            Bounds.Max.X = FMath::Max(Bounds.Max.X, X);
+            Bounds.Max.Y = FMath::Max(Bounds.Max.Y, Y);
+        }
+    }
 
-        // Step 1: Initialize seed cells (they point to themselves)
-    for(const FGridSeed& S : Seeds)
+    const FGridSeed* SeedData = Seeds.GetData();
+    const int16* Continent = VoxelGrid.Continent.GetData();
+    int32* Column = VoxelGrid.SeedIndexBack.GetData();
+    int32* Result = VoxelGrid.SeedIndex.GetData();
+    const int32 Stride = GridSizeX;
+
+    for (int32 c = 0; c < NumContinents; c++)
     {
-        FVoxelCell* SeedCell = GetCell(S.X, S.Y);
-        if (SeedCell)
+        const FIntRect Bounds = ContinentBounds[c];
+        if (Bounds.Max.X < Bounds.Min.X) continue; // Continente senza celle
+
+        // Pulisci lo scratch nel rettangolo (può contenere dati di un continente precedente)
+        for (int32 Y = Bounds.Min.Y; Y <= Bounds.Max.Y; Y++)
         {
-            SeedCell->ClosestSeed = &S;
+            FMemory::Memset(Column + Y * Stride + Bounds.Min.X, 0xFF, (Bounds.Max.X - Bounds.Min.X + 1) * sizeof(int32));
         }
-    }
 
-    // Step 2: Jump Flood iterations with decreasing jump size
-    int32 MaxDimension = FMath::Max(GridSizeX, GridSizeY);
-    int32 JumpSize = FMath::RoundUpToPowerOfTwo(MaxDimension) / 2; // Start from nearest power of 2
+        // Marca i seed del continente (a parità di cella vince il primo, come nel brute force)
+        bool bHasSeeds = false;
+        for (int32 SeedIdx = 0; SeedIdx < Seeds.Num(); SeedIdx++)
+        {
+            const FGridSeed& S = SeedData[SeedIdx];
+            if (S.ContIndex != c) continue;
 
-    UE_LOG(LogRosikoMapGen, Log, TEXT("Jump Flood Algorithm starting, MaxJump: %d"), JumpSize);
+            int32& Slot = Column[S.Y * Stride + S.X];
+            if (Slot == INDEX_NONE) Slot = SeedIdx;
+            bHasSeeds = true;
+        }
+        if (!bHasSeeds) continue;
 
-    while (JumpSize >= 1)
-    {
-        for (int32 Y = 0; Y < GridSizeY; Y++)
+        // PASSO 1: colonne indipendenti. Due sweep in-place (giù e su): una cella contiene
+        // un seed "originale" solo se Seeds[idx].Y coincide con la sua riga.
+        ParallelFor(Bounds.Max.X - Bounds.Min.X + 1, [&, Bounds](int32 ColOffset)
         {
-            for (int32 X = 0; X < GridSizeX; X++)
-            {
-                FVoxelCell* Cell = GetCell(X, Y);
-                if (!Cell || Cell->ContinentIndex == -1) continue; // Skip ocean/invalid
+            const int32 X = Bounds.Min.X + ColOffset;
 
-                const FGridSeed* CurrentBest = Cell->ClosestSeed;
-                float CurrentBestDistSq = FLT_MAX;
+            int32 Above = INDEX_NONE;
+            for (int32 Y = Bounds.Min.Y; Y <= Bounds.Max.Y; Y++)
+            {
+                int32& Slot = Column[Y * Stride + X];
+                if (Slot != INDEX_NONE && SeedData[Slot].Y == Y) Above = Slot;
+                else Slot = Above;
+            }
 
-                if (CurrentBest)
+            int32 Below = INDEX_NONE;
+            for (int32 Y = Bounds.Max.Y; Y >= Bounds.Min.Y; Y--)
+            {
+                int32& Slot = Column[Y * Stride + X];
+                if (Slot != INDEX_NONE && SeedData[Slot].Y == Y)
                 {
-                    CurrentBestDistSq = (float)(FMath::Square(CurrentBest->X - X) + FMath::Square(CurrentBest->Y - Y));
+                    Below = Slot;
                 }
-
-                // Check 9 positions at distance JumpSize (3x3 grid centered on current cell)
-                for(int32 DY = -1; DY <= 1; DY++)
+                else if (Below != INDEX_NONE)
                 {
-                    for(int32 DX = -1; DX <= 1; DX++)
+                    // A parità di distanza teniamo il seed sopra
+                    if (Slot == INDEX_NONE || (SeedData[Below].Y - Y) < (Y - SeedData[Slot].Y))
                     {
-                        int32 CheckX = X + DX * JumpSize;
-                        int32 CheckY = Y + DY * JumpSize;
+                        Slot = Below;
+                    }
+                }
+            }
+        });
+
+        // PASSO 2: righe indipendenti. Ogni colonna q con un seed contribuisce la parabola
+        // f(x) = dy(q)^2 + (x - q)^2; l'inviluppo inferiore dà il seed più vicino per ogni x.
+        ParallelFor(Bounds.Max.Y - Bounds.Min.Y + 1, [&, Bounds, c](int32 RowOffset)
+        {
+            const int32 Y = Bounds.Min.Y + RowOffset;
+            const int32 Width = Bounds.Max.X - Bounds.Min.X + 1;
+            const int32* ColumnRow = Column + Y * Stride;
 
-                        FVoxelCell* Neighbor = GetCell(CheckX, CheckY);
-                        if (!Neighbor || !Neighbor->ClosestSeed) continue;
+            TArray<int32, TInlineAllocator<256>> Vertices;   // Colonne delle parabole nell'inviluppo
+            TArray<double, TInlineAllocator<257>> Breaks;    // Intervallo di dominanza di ciascuna
+            Vertices.SetNumUninitialized(Width);
+            Breaks.SetNumUninitialized(Width + 1);
 
-                        // IMPORTANT: Only propagate seeds within same continent
-                        if (Neighbor->ClosestSeed->ContIndex != Cell->ContinentIndex) continue;
+            auto ColumnCost = [&](int32 Q) -> double
+            {
+                const double DY = (double)(SeedData[ColumnRow[Q]].Y - Y);
+                return DY * DY + (double)Q * (double)Q;
+            };
 
-                        // Calculate distance from current cell to neighbor's closest seed
-                        float DistToNeighborSeedSq = (float)(
-                            FMath::Square(Neighbor->ClosestSeed->X - X) +
-                            FMath::Square(Neighbor->ClosestSeed->Y - Y)
-                        );
+            int32 K = -1;
+            for (int32 Q = Bounds.Min.X; Q <= Bounds.Max.X; Q++)
+            {
+                if (ColumnRow[Q] == INDEX_NONE) continue;
 
-                        // If neighbor's seed is closer, adopt it
-                        if (DistToNeighborSeedSq < CurrentBestDistSq)
-                        {
-                            CurrentBestDistSq = DistToNeighborSeedSq;
-                            CurrentBest = Neighbor->ClosestSeed;
-                        }
-                    }
+                const double CostQ = ColumnCost(Q);
+                double Intersection = -DBL_MAX;
+                while (K >= 0)
+                {
+                    const int32 V = Vertices[K];
+                    Intersection = (CostQ - ColumnCost(V)) / (2.0 * (Q - V));
+                    if (Intersection > Breaks[K]) break;
+                    K--;
                 }
 
-                // Update cell with best seed found
-                Cell->ClosestSeed = CurrentBest;
+                K++;
+                Vertices[K] = Q;
+                Breaks[K] = (K == 0) ? -DBL_MAX : Intersection;
+                Breaks[K + 1] = DBL_MAX;
             }
-        }
 
-        JumpSize /= 2;
+            if (K < 0) return; // Nessun seed raggiungibile in questa riga (impossibile se il continente ha seed)
+
+            K = 0;
+            for (int32 X = Bounds.Min.X; X <= Bounds.Max.X; X++)
+            {
+                while (Breaks[K + 1] < (double)X) K++;
+
+                const int32 CellIdx = Y * Stride + X;
+                if (Continent[CellIdx] == c)
+                {
+                    Result[CellIdx] = ColumnRow[Vertices[K]];
+                }
+            }
+        });
     }
+}
+
+void AMapGenerator::AssignTerritoriesFromSeedIndex(const TArray<FGridSeed>& Seeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenAssignTerritories);
 
-    // Step 3: Assign TerritoryID and Height based on ClosestSeed
+    // Seriale: l'ordine di consumo di RNG deve restare deterministico (riga per riga)
     for (int32 Y = 0; Y < GridSizeY; Y++)
     {
         for (int32 X = 0; X < GridSizeX; X++)
         {
-            FVoxelCell* Cell = GetCell(X, Y);
-            if (!Cell || Cell->ContinentIndex == -1 || !Cell->ClosestSeed) continue;
+            const int32 CellIdx = Y * GridSizeX + X;
+            const int32 SeedIdx = VoxelGrid.SeedIndex[CellIdx];
+            if (VoxelGrid.Continent[CellIdx] == -1 || SeedIdx == INDEX_NONE) continue;
 
-            Cell->TerritoryID = Cell->ClosestSeed->ID;
+            const FGridSeed& Seed = Seeds[SeedIdx];
+            VoxelGrid.Territory[CellIdx] = (int16)Seed.ID;
 
             // Assign height: Territory Base + Cell Variation
             float CellVariation = RNG.FRandRange(Configuration->CellHeightRange.X, Configuration->CellHeightRange.Y);
-            Cell->Height = Cell->ClosestSeed->BaseHeight + CellVariation;
+            VoxelGrid.Height[CellIdx] = FVoxelGrid::QuantizeHeight(Seed.BaseHeight + CellVariation);
         }
     }
 
-        UE_LOG(LogRosikoMapGen, Log, TEXT("Jump Flood Algorithm completed"));
-    }
-    else
-    {
-        // BRUTE FORCE: O(N*M) - Check every cell against every seed
-        UE_LOG(LogRosikoMapGen, Log, TEXT("Using Brute Force for Voronoi (slower, for comparison)"));
+    // I piani SeedIndex non servono più dopo l'assegnazione
+    VoxelGrid.SeedIndex.Empty();
+    VoxelGrid.SeedIndexBack.Empty();
+}
 
-        // Put seeds in per-continent buckets for faster lookup
-        TMap<int32, TArray<FGridSeed>> SeedsByCont;
-        for(const FGridSeed& S : Seeds)
-        {
-            SeedsByCont.FindOrAdd(S.ContIndex).Add(S);
-        }
+void AMapGenerator::AssignTerritoriesBruteForce(const TArray<FGridSeed>& Seeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenAssignTerritories);
 
-        for (int32 Y = 0; Y < GridSizeY; Y++)
+    // Put seed indices in per-continent buckets for faster lookup
+    TMap<int32, TArray<int32>> SeedsByCont;
+    for (int32 SeedIdx = 0; SeedIdx < Seeds.Num(); SeedIdx++)
+    {
+        SeedsByCont.FindOrAdd(Seeds[SeedIdx].ContIndex).Add(SeedIdx);
+    }
+
+    // Seriale: il consumo dell'RNG deve seguire l'ordine delle righe
+    for (int32 Y = 0; Y < GridSizeY; Y++)
+    {
+        for (int32 X = 0; X < GridSizeX; X++)
         {
-            for (int32 X = 0; X < GridSizeX; X++)
-            {
-                FVoxelCell* Cell = GetCell(X, Y);
-                if (!Cell || Cell->ContinentIndex == -1) continue;
+            const int32 CellIdx = Y * GridSizeX + X;
+            const int32 ContinentIndex = VoxelGrid.Continent[CellIdx];
+            if (ContinentIndex == -1) continue;
 
-                TArray<FGridSeed>* ContSeeds = SeedsByCont.Find(Cell->ContinentIndex);
-                if (!ContSeeds) continue;
+            const TArray<int32>* ContSeeds = SeedsByCont.Find(ContinentIndex);
+            if (!ContSeeds) continue;
 
-                float MinDistSq = FLT_MAX;
-                const FGridSeed* BestSeed = nullptr;
+            float MinDistSq = FLT_MAX;
+            const FGridSeed* BestSeed = nullptr;
 
-                for(const FGridSeed& S : *ContSeeds)
+            for (int32 SeedIdx : *ContSeeds)
+            {
+                const FGridSeed& S = Seeds[SeedIdx];
+                float DistSq = (float)(FMath::Square(S.X - X) + FMath::Square(S.Y - Y));
+                if (DistSq < MinDistSq)
                 {
-                    float DistSq = (float)(FMath::Square(S.X - X) + FMath::Square(S.Y - Y));
-                    if (DistSq < MinDistSq)
-                    {
-                        MinDistSq = DistSq;
-                        BestSeed = &S;
-                    }
+                    MinDistSq = DistSq;
+                    BestSeed = &S;
                 }
+            }
 
-                if (BestSeed)
-                {
-                    Cell->TerritoryID = BestSeed->ID;
-                    float CellVariation = RNG.FRandRange(Configuration->CellHeightRange.X, Configuration->CellHeightRange.Y);
-                    Cell->Height = BestSeed->BaseHeight + CellVariation;
-                }
+            if (BestSeed)
+            {
+                VoxelGrid.Territory[CellIdx] = (int16)BestSeed->ID;
+                float CellVariation = RNG.FRandRange(Configuration->CellHeightRange.X, Configuration->CellHeightRange.Y);
+                VoxelGrid.Height[CellIdx] = FVoxelGrid::QuantizeHeight(BestSeed->BaseHeight + CellVariation);
             }
         }
     }
+}
 
-    double VoronoiEndTime = FPlatformTime::Seconds();
-    UE_LOG(LogRosikoMapGen, Warning, TEXT("Voronoi Generation Time: %.2f ms (JFA: %s)"),
-        (VoronoiEndTime - VoronoiStartTime) * 1000.0,
-        Configuration->bUseJumpFloodAlgorithm ? TEXT("ON") : TEXT("OFF"));
+void AMapGenerator::RunVoronoi(const TArray<FGridSeed>& Seeds, EVoronoiAlgorithm Algorithm)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenVoronoi);
 
-    // 5. Build Meshes
-    // Create FGeneratedTerritory entries for each Seed (using global ID)
-    GeneratedData.AddDefaulted(GlobalID);
+    switch (Algorithm)
+    {
+    case EVoronoiAlgorithm::JumpFlood:
+    {
+        // JUMP FLOOD ALGORITHM: O(N log N) instead of O(N*M)
+        // JFA propagates nearest seed information through "jumps" of decreasing size
 
-    // Traccia i nomi usati per continente (per evitare duplicati)
-    TMap<int32, TArray<FString>> UsedNamesPerContinent;
-    for (int32 c = 0; c < Configuration->ContinentSetup.Num(); c++)
+        // Step 1: Initialize seed cells (they point to themselves)
+        InitJumpFlood(Seeds);
+
+        // Step 2: Jump Flood iterations with decreasing jump size
+        int32 MaxDimension = FMath::Max(GridSizeX, GridSizeY);
+        int32 JumpSize = FMath::RoundUpToPowerOfTwo(MaxDimension) / 2; // Start from nearest power of 2
+
+        UE_LOG(LogRosikoMapGen, Verbose, TEXT("Jump Flood Algorithm starting, MaxJump: %d"), JumpSize);
+
+        while (JumpSize >= 1)
+        {
+            RunJumpFloodPass(Seeds, JumpSize);
+            JumpSize /= 2;
+        }
+
+        // Step 3: Assign TerritoryID and Height based on closest seed
+        AssignTerritoriesFromSeedIndex(Seeds);
+        break;
+    }
+    case EVoronoiAlgorithm::ExactDistanceTransform:
+        // Distance transform esatto: due passi paralleli, nessun errore sui confini
+        RunExactDistanceTransform(Seeds);
+        AssignTerritoriesFromSeedIndex(Seeds);
+        break;
+
+    case EVoronoiAlgorithm::BruteForce:
+    default:
+        // BRUTE FORCE: O(N*M) - Check every cell against every seed
+        AssignTerritoriesBruteForce(Seeds);
+        break;
+    }
+}
+
+int32 AMapGenerator::GenerateTerritorySeeds(TArray<FGridSeed>& OutSeeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenSeeds);
+
+    OutSeeds.Empty();
+    int32 GlobalID = 0;
+
+    const int32 NumContinents = Configuration->ContinentSetup.Num();
+    const int32 NumCells = VoxelGrid.Num();
+
+    // Bucket delle celle per continente in UN solo passaggio (counting sort -> CSR).
+    // Dentro ogni bucket le celle restano in ordine di griglia, quindi il risultato è deterministico.
+    TArray<int32> ContinentOffsets;
+    ContinentOffsets.Init(0, NumContinents + 1);
+    for (int32 i = 0; i < NumCells; i++)
+    {
+        const int32 c = VoxelGrid.Continent[i];
+        if (c >= 0) ContinentOffsets[c + 1]++;
+    }
+    for (int32 c = 0; c < NumContinents; c++)
+    {
+        ContinentOffsets[c + 1] += ContinentOffsets[c];
+    }
+
+    TArray<int32> ContinentCells;
+    ContinentCells.SetNumUninitialized(ContinentOffsets[NumContinents]);
+    {
+        TArray<int32> Cursor(ContinentOffsets.GetData(), NumContinents);
+        for (int32 i = 0; i < NumCells; i++)
+        {
+            const int32 c = VoxelGrid.Continent[i];
+            if (c >= 0) ContinentCells[Cursor[c]++] = i;
+        }
+    }
+
+    // Spatial hash per il Poisson-disk: bucket di lato R/sqrt(2) => al massimo un seed per bucket,
+    // e basta controllare i bucket entro +/-2 per sapere se c'è un seed a distanza < R.
+    TArray<int32> Buckets;
+    int32 BucketsX = 0;
+    int32 BucketsY = 0;
+    float BucketSize = 1.0f;
+
+    for (int32 c = 0; c < NumContinents; c++)
+    {
+        const FContinentDefinition& Cont = Configuration->ContinentSetup[c];
+        const int32 NumCandidates = ContinentOffsets[c + 1] - ContinentOffsets[c];
+        const int32 TargetCount = FMath::Min(Cont.TerritoryCount, NumCandidates); // Un seed per cella al massimo
+
+        if (TargetCount <= 0) continue;
+
+        TArray<int32> Candidates(ContinentCells.GetData() + ContinentOffsets[c], NumCandidates);
+        const int32 FirstSeed = OutSeeds.Num();
+
+        // Raggio iniziale: ~0.8 volte la spaziatura di K dischi che coprono N celle.
+        // Se un giro completo non piazza abbastanza seed il raggio si riduce (i seed già piazzati restano).
+        float Radius = 0.8f * FMath::Sqrt((float)NumCandidates / (float)TargetCount);
+
+        while (OutSeeds.Num() - FirstSeed < TargetCount)
+        {
+            const float RadiusSq = FMath::Square(Radius);
+            const bool bUseDisk = Radius >= 1.0f;
+
+            if (bUseDisk)
+            {
+                // Ricostruisci la griglia di bucket per il raggio corrente con i seed di questo continente
+                BucketSize = Radius * UE_INV_SQRT_2;
+                BucketsX = FMath::CeilToInt(GridSizeX / BucketSize) + 1;
+                BucketsY = FMath::CeilToInt(GridSizeY / BucketSize) + 1;
+                Buckets.Init(INDEX_NONE, BucketsX * BucketsY);
+                for (int32 SeedIdx = FirstSeed; SeedIdx < OutSeeds.Num(); SeedIdx++)
+                {
+                    const FGridSeed& S = OutSeeds[SeedIdx];
+                    Buckets[(int32)(S.Y / BucketSize) * BucketsX + (int32)(S.X / BucketSize)] = SeedIdx;
+                }
+            }
+
+            // Permutazione casuale parziale (Fisher-Yates): visitiamo le candidate in ordine casuale
+            // senza ripetizioni, fermandoci appena abbiamo tutti i seed. Le celle già seed sono rimosse.
+            int32 NumLeft = Candidates.Num();
+            for (int32 k = 0; k < NumLeft && OutSeeds.Num() - FirstSeed < TargetCount; )
+            {
+                const int32 Pick = RNG.RandRange(k, NumLeft - 1);
+                Candidates.Swap(k, Pick);
+
+                const int32 CellIdx = Candidates[k];
+                const int32 EX = CellIdx % GridSizeX;
+                const int32 EY = CellIdx / GridSizeX;
+
+                bool bTooClose = false;
+                int32 BX = 0, BY = 0;
+                if (bUseDisk)
+                {
+                    BX = (int32)(EX / BucketSize);
+                    BY = (int32)(EY / BucketSize);
+                    for (int32 NY = FMath::Max(BY - 2, 0); NY <= FMath::Min(BY + 2, BucketsY - 1) && !bTooClose; NY++)
+                    {
+                        for (int32 NX = FMath::Max(BX - 2, 0); NX <= FMath::Min(BX + 2, BucketsX - 1); NX++)
+                        {
+                            const int32 Other = Buckets[NY * BucketsX + NX];
+                            if (Other != INDEX_NONE && FMath::Square(OutSeeds[Other].X - EX) + FMath::Square(OutSeeds[Other].Y - EY) < RadiusSq)
+                            {
+                                bTooClose = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if (bTooClose)
+                {
+                    k++;
+                    continue;
+                }
+
+                // Generate base height for this territory
+                float TerritoryBaseHeight = RNG.FRandRange(Configuration->TerritoryHeightRange.X, Configuration->TerritoryHeightRange.Y);
+
+                FGridSeed NewSeed;
+                NewSeed.ID = GlobalID++;
+                NewSeed.ContIndex = c;
+                NewSeed.X = EX;
+                NewSeed.Y = EY;
+                NewSeed.BaseHeight = TerritoryBaseHeight;
+                const int32 SeedIdx = OutSeeds.Add(NewSeed);
+
+                if (bUseDisk)
+                {
+                    Buckets[BY * BucketsX + BX] = SeedIdx;
+                }
+
+                // Initial Assignment
+                VoxelGrid.Territory[CellIdx] = (int16)NewSeed.ID;
+
+                // Togli la cella dalle candidate (swap con l'ultima della parte ancora valida)
+                Candidates.Swap(k, --NumLeft);
+            }
+            Candidates.SetNum(NumLeft, false);
+
+            Radius *= 0.75f;
+        }
+    }
+
+    return GlobalID;
+}
+
+void AMapGenerator::InitTerritoryMetadata(const TArray<FGridSeed>& Seeds)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenMetadata);
+
+    // Create FGeneratedTerritory entries for each Seed (using global ID)
+    GeneratedData.AddDefaulted(Seeds.Num());
+
+    // Traccia i nomi usati per continente (per evitare duplicati)
+    TMap<int32, TArray<FString>> UsedNamesPerContinent;
+    for (int32 c = 0; c < Configuration->ContinentSetup.Num(); c++)
+    {
+        UsedNamesPerContinent.Add(c, TArray<FString>());
+    }
+
+    for (const FGridSeed& S : Seeds)
+    {
+        if (S.ID >= GeneratedData.Num()) continue;
+
+        FGeneratedTerritory& Data = GeneratedData[S.ID];
+        Data.ID = S.ID;
+        Data.ContinentID = S.ContIndex;
+
+        FLinearColor BaseColor = Configuration->ContinentSetup[S.ContIndex].Color;
+        Data.DebugColor = BaseColor;
+
+        // Generate territory-specific color variation (darker shade)
+        float BrightnessMultiplier = RNG.FRandRange(Configuration->TerritoryBrightnessRange.X, Configuration->TerritoryBrightnessRange.Y);
+        FLinearColor TerritoryColor = BaseColor * BrightnessMultiplier;
+        TerritoryColor.A = 1.0f; // Preserve alpha
+        Data.TerritoryColor = TerritoryColor;
+
+        Data.bIsOcean = false;
+
+        // Assegna un nome random dal pool del continente
+        const FContinentDefinition& Continent = Configuration->ContinentSetup[S.ContIndex];
+        TArray<FString>& UsedNames = UsedNamesPerContinent[S.ContIndex];
+        FString TerritoryName;
+
+        if (Continent.TerritoryNames.Num() > 0)
+        {
+            // Crea un pool di nomi disponibili (non ancora usati)
+            TArray<FString> AvailableNames;
+            for (const FString& Name : Continent.TerritoryNames)
+            {
+                if (!UsedNames.Contains(Name))
+                {
+                    AvailableNames.Add(Name);
+                }
+            }
+
+            // Se abbiamo nomi disponibili, pescane uno random
+            if (AvailableNames.Num() > 0)
+            {
+                int32 RandomIndex = RNG.RandRange(0, AvailableNames.Num() - 1);
+                TerritoryName = AvailableNames[RandomIndex];
+            }
+            else
+            {
+                // Se abbiamo esaurito i nomi, genera un nome con suffisso numerico
+                int32 Suffix = UsedNames.Num() - Continent.TerritoryNames.Num() + 1;
+                TerritoryName = FString::Printf(TEXT("%s %d"), *Continent.Name, Suffix);
+            }
+            UsedNames.Add(TerritoryName);
+        }
+        else
+        {
+            // Fallback: genera nome generico se il continente non ha nomi definiti
+            TerritoryName = FString::Printf(TEXT("%s Territory %d"), *Continent.Name, S.ID);
+        }
+
+        Data.Name = TerritoryName;
+
+        // Center calculation using seed location and height
+        float WorldX = (float)S.X / GridSizeX * (Configuration->MapSize.X*2) - Configuration->MapSize.X;
+        float WorldY = (float)S.Y / GridSizeY * (Configuration->MapSize.Y*2) - Configuration->MapSize.Y;
+        Data.CenterPoint = FVector(WorldX, WorldY, S.BaseHeight);
+    }
+}
+
+void AMapGenerator::BuildTerritoryAdjacency()
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenAdjacency);
+
+    // Un solo scan della griglia: due territori confinano se hanno celle adiacenti (destra/sotto bastano,
+    // la relazione è simmetrica). L'oceano (-1) separa, quindi non crea archi.
+    const int32 NumTerritories = GeneratedData.Num();
+    const int16* Territory = VoxelGrid.Territory.GetData();
+
+    TArray<uint64> Edges; // (min << 32) | max
+    uint64 LastEdge = MAX_uint64;
+
+    auto AddEdge = [&](int16 A, int16 B)
+    {
+        if (A == B || A == -1 || B == -1) return;
+        const uint64 Edge = ((uint64)FMath::Min(A, B) << 32) | (uint64)FMath::Max(A, B);
+        if (Edge == LastEdge) return; // Lungo un confine lo stesso arco si ripete cella dopo cella
+        LastEdge = Edge;
+        Edges.Add(Edge);
+    };
+
+    for (int32 Y = 0; Y < GridSizeY; Y++)
+    {
+        for (int32 X = 0; X < GridSizeX; X++)
+        {
+            const int32 CellIdx = Y * GridSizeX + X;
+            const int16 T = Territory[CellIdx];
+            if (T == -1) continue;
+
+            if (X + 1 < GridSizeX) AddEdge(T, Territory[CellIdx + 1]);
+            if (Y + 1 < GridSizeY) AddEdge(T, Territory[CellIdx + GridSizeX]);
+        }
+    }
+
+    // Dedup: ordinati per (min, max) gli archi uguali diventano contigui
+    Algo::Sort(Edges);
+    Edges.SetNum(Algo::Unique(Edges));
+
+    // CSR: conteggio gradi -> prefix sum -> riempimento (entrambe le direzioni)
+    AdjacencyOffsets.Init(0, NumTerritories + 1);
+    for (uint64 Edge : Edges)
+    {
+        AdjacencyOffsets[(int32)(Edge >> 32) + 1]++;
+        AdjacencyOffsets[(int32)(Edge & 0xFFFFFFFF) + 1]++;
+    }
+    for (int32 T = 0; T < NumTerritories; T++)
+    {
+        AdjacencyOffsets[T + 1] += AdjacencyOffsets[T];
+    }
+
+    AdjacencyIndices.SetNumUninitialized(AdjacencyOffsets[NumTerritories]);
+    TArray<int32> Cursor(AdjacencyOffsets.GetData(), NumTerritories);
+    for (uint64 Edge : Edges)
+    {
+        const int32 A = (int32)(Edge >> 32);
+        const int32 B = (int32)(Edge & 0xFFFFFFFF);
+        AdjacencyIndices[Cursor[A]++] = B;
+        AdjacencyIndices[Cursor[B]++] = A;
+    }
+
+    // Righe ordinate: AreTerritoriesAdjacent usa la ricerca binaria
+    for (int32 T = 0; T < NumTerritories; T++)
+    {
+        TArrayView<int32> Row(AdjacencyIndices.GetData() + AdjacencyOffsets[T], AdjacencyOffsets[T + 1] - AdjacencyOffsets[T]);
+        Algo::Sort(Row);
+        GeneratedData[T].NeighborIDs = TArray<int32>(Row.GetData(), Row.Num());
+    }
+
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Adjacency built: %d territories, %d borders"), NumTerritories, Edges.Num());
+}
+
+TArrayView<const int32> AMapGenerator::GetTerritoryNeighbors(int32 TerritoryID) const
+{
+    if (TerritoryID < 0 || TerritoryID + 1 >= AdjacencyOffsets.Num())
+    {
+        return TArrayView<const int32>();
+    }
+
+    const int32 Start = AdjacencyOffsets[TerritoryID];
+    return TArrayView<const int32>(AdjacencyIndices.GetData() + Start, AdjacencyOffsets[TerritoryID + 1] - Start);
+}
+
+bool AMapGenerator::AreTerritoriesAdjacent(int32 TerritoryA, int32 TerritoryB) const
+{
+    const TArrayView<const int32> Neighbors = GetTerritoryNeighbors(TerritoryA);
+    return Algo::BinarySearch(Neighbors, TerritoryB) != INDEX_NONE;
+}
+
+void AMapGenerator::BuildTerritoryGeometry()
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenGeometry);
+
+    const double StartTime = FPlatformTime::Seconds();
+
+    FTerritoryCellBuckets Buckets;
+    BucketCellsByTerritory(Buckets);
+
+    GeneratedMeshes.Reset();
+    GeneratedMeshes.SetNum(GeneratedData.Num());
+
+    // Un task per territorio: ogni builder scrive solo nel proprio FGeneratedTerritory e ha la sua
+    // tabella di saldatura dei vertici, la griglia è in sola lettura. Territori di dimensioni molto
+    // diverse -> Unbalanced (work stealing per elemento invece di blocchi fissi).
+    const FVector2D CellSize((Configuration->MapSize.X * 2.0f) / (float)GridSizeX, (Configuration->MapSize.Y * 2.0f) / (float)GridSizeY);
+    const FVector2D Origin = -Configuration->MapSize;
+    const bool bWeldVertices = Configuration->bWeldVertices;
+    const bool bUseGreedyMeshing = Configuration->bUseGreedyMeshing;
+
+    ParallelFor(GeneratedData.Num(), [&](int32 TerritoryIndex)
+    {
+        TRACE_CPUPROFILER_EVENT_SCOPE(BuildTerritoryMesh);
+
+        const TArrayView<const FCellSpan> Spans = Buckets.GetSpans(TerritoryIndex);
+        if (Spans.Num() == 0) return;
+
+        FGeneratedTerritoryMesh& Mesh = GeneratedMeshes[TerritoryIndex];
+        FTerritoryMeshBuilder Builder(GeneratedData[TerritoryIndex], Mesh, CellSize, Origin, bWeldVertices);
+
+        if (bUseGreedyMeshing)
+        {
+            BuildTerritoryGeometryGreedy(Builder, (int16)TerritoryIndex, Spans, Buckets.Bounds[TerritoryIndex]);
+        }
+        else
+        {
+            BuildTerritoryGeometryPerCell(Builder, (int16)TerritoryIndex, Spans);
+        }
+
+        // Le stime di Reserve sono pessimistiche con greedy/welding: restituisci la memoria in eccesso
+        Mesh.Vertices.Shrink();
+        Mesh.Normals.Shrink();
+        Mesh.VertexColors.Shrink();
+        Mesh.Triangles.Shrink();
+    }, EParallelForFlags::Unbalanced);
+
+    UpdateGeometryStats();
+
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Geometry built in %.2f ms: %d vertices, %d triangles (greedy: %s, weld: %s)"),
+        MillisecondsSince(StartTime), PipelineStats.TotalVertices, PipelineStats.TotalTriangles,
+        bUseGreedyMeshing ? TEXT("ON") : TEXT("OFF"),
+        bWeldVertices ? TEXT("ON") : TEXT("OFF"));
+}
+
+void AMapGenerator::UpdateGeometryStats()
+{
+    PipelineStats.NumTerritories = GeneratedData.Num();
+    PipelineStats.TotalVertices = 0;
+    PipelineStats.TotalTriangles = 0;
+
+    SIZE_T MeshBytes = 0;
+    for (const FGeneratedTerritoryMesh& Mesh : GeneratedMeshes)
+    {
+        PipelineStats.TotalVertices += Mesh.Vertices.Num();
+        PipelineStats.TotalTriangles += Mesh.Triangles.Num() / 3;
+        MeshBytes += Mesh.GetAllocatedSize();
+    }
+
+    SET_MEMORY_STAT(STAT_RosikoTerritoryMeshMemory, MeshBytes);
+    SET_MEMORY_STAT(STAT_RosikoVoxelGridMemory, VoxelGrid.GetAllocatedSize());
+}
+
+void AMapGenerator::BucketCellsByTerritory(FTerritoryCellBuckets& OutBuckets) const
+{
+    const int32 NumTerritories = GeneratedData.Num();
+    const int16* Territory = VoxelGrid.Territory.GetData();
+
+    // Span = tratto di riga dello stesso territorio; scan in ordine Y, X
+    auto ForEachSpan = [&](auto&& Func)
+    {
+        for (int32 Y = 0; Y < GridSizeY; Y++)
+        {
+            const int16* Row = Territory + Y * GridSizeX;
+            int32 X0 = 0;
+            while (X0 < GridSizeX)
+            {
+                const int16 TerritoryID = Row[X0];
+                int32 X1 = X0 + 1;
+                while (X1 < GridSizeX && Row[X1] == TerritoryID) X1++;
+
+                if (TerritoryID != -1) Func(TerritoryID, Y, X0, X1);
+                X0 = X1;
+            }
+        }
+    };
+
+    // CSR come per l'adiacenza: conteggio -> prefix sum -> riempimento
+    OutBuckets.Offsets.Init(0, NumTerritories + 1);
+    ForEachSpan([&](int16 TerritoryID, int32, int32, int32)
+    {
+        OutBuckets.Offsets[TerritoryID + 1]++;
+    });
+    for (int32 T = 0; T < NumTerritories; T++)
+    {
+        OutBuckets.Offsets[T + 1] += OutBuckets.Offsets[T];
+    }
+
+    OutBuckets.Spans.SetNumUninitialized(OutBuckets.Offsets[NumTerritories]);
+    OutBuckets.Bounds.Init(FIntRect(MAX_int32, MAX_int32, MIN_int32, MIN_int32), NumTerritories);
+    TArray<int32> Cursor(OutBuckets.Offsets.GetData(), NumTerritories);
+    ForEachSpan([&](int16 TerritoryID, int32 Y, int32 X0, int32 X1)
+    {
+        OutBuckets.Spans[Cursor[TerritoryID]++] = FCellSpan{ Y, X0, X1 };
+
+        FIntRect& Bounds = OutBuckets.Bounds[TerritoryID];
+        Bounds.Min.X = FMath::Min(Bounds.Min.X, X0);
+        Bounds.Min.Y = FMath::Min(Bounds.Min.Y, Y);
+        Bounds.Max.X = FMath::Max(Bounds.Max.X, X1);
+        Bounds.Max.Y = FMath::Max(Bounds.Max.Y, Y + 1);
+    });
+}
+
+void AMapGenerator::BuildTerritoryGeometryPerCell(FTerritoryMeshBuilder& Builder, int16 TerritoryID, TArrayView<const FCellSpan> Spans) const
+{
+    // Geometry Construction: "Cubes" per cell, but optimized (Face Culling)
+
+    // OPTIMIZATION: Pre-allocate memory for mesh arrays
+    // Estimate: ~16-20 vertices per cell (top + sides, no bottom); welding ne riusa circa 3 su 4
+    int32 NumCells = 0;
+    for (const FCellSpan& Span : Spans)
+    {
+        NumCells += Span.X1 - Span.X0;
+    }
+    const int32 EstimatedVertices = NumCells * (Builder.bWeldVertices ? 6 : 20);
+    const int32 EstimatedTriangles = NumCells * 20 * 2;
+
+    Builder.Mesh.Vertices.Reserve(EstimatedVertices);
+    Builder.Mesh.Normals.Reserve(EstimatedVertices);
+    Builder.Mesh.VertexColors.Reserve(EstimatedVertices);
+    Builder.Mesh.Triangles.Reserve(EstimatedTriangles);
+    if (Builder.bWeldVertices)
+    {
+        Builder.VertexLookup.Reserve(EstimatedVertices);
+    }
+
+    const int16 HeightThresholdQ = FVoxelGrid::QuantizeHeight(Configuration->HeightDifferenceThreshold);
+
+    // Span in ordine Y, X: stesso ordine dei vertici della scansione completa della griglia
+    for (const FCellSpan& Span : Spans)
+    {
+        const int32 Y = Span.Y;
+        for (int32 X = Span.X0; X < Span.X1; X++)
+        {
+            const int32 CellIdx = Y * GridSizeX + X;
+            const int16 HeightQ = VoxelGrid.Height[CellIdx]; // Use dynamic height from cell
+
+            // Top Face (Z-Up): corner (X,Y) - (X+1,Y+1)
+            Builder.AddTopFace(X, Y, X + 1, Y + 1, HeightQ);
+
+            // SIDE FACES (Only if Neighbor is different, Ocean, or different height)
+
+            // Check Right (X+1): TR -> BR
+            if (NeedsSideFace(GetCellIndex(X + 1, Y), TerritoryID, HeightQ, HeightThresholdQ))
+            {
+                Builder.AddSideFace(X + 1, Y, X + 1, Y + 1, HeightQ, FTerritoryMeshBuilder::NormalPosX);
+            }
+
+            // Check Left (X-1): BL -> TL
+            if (NeedsSideFace(GetCellIndex(X - 1, Y), TerritoryID, HeightQ, HeightThresholdQ))
+            {
+                Builder.AddSideFace(X, Y + 1, X, Y, HeightQ, FTerritoryMeshBuilder::NormalNegX);
+            }
+
+            // Check Top (Y-1): TL -> TR
+            if (NeedsSideFace(GetCellIndex(X, Y - 1), TerritoryID, HeightQ, HeightThresholdQ))
+            {
+                Builder.AddSideFace(X, Y, X + 1, Y, HeightQ, FTerritoryMeshBuilder::NormalNegY);
+            }
+
+            // Check Bottom (Y+1): BR -> BL
+            if (NeedsSideFace(GetCellIndex(X, Y + 1), TerritoryID, HeightQ, HeightThresholdQ))
+            {
+                Builder.AddSideFace(X + 1, Y + 1, X, Y + 1, HeightQ, FTerritoryMeshBuilder::NormalPosY);
+            }
+        }
+    }
+}
+
+void AMapGenerator::BuildTerritoryGeometryGreedy(FTerritoryMeshBuilder& Builder, int16 TerritoryID, TArrayView<const FCellSpan> Spans, const FIntRect& Bounds) const
+{
+    // Greedy meshing: le facce superiori di celle adiacenti con stesso territorio e stessa
+    // altezza quantizzata sono complanari, quindi le fondiamo in rettangoli massimali.
+    // Le facce laterali vengono fuse in strisce lungo il bordo. Silhouette identica al per-cell.
+    // Un rettangolo/striscia non esce mai dal territorio, quindi lavorare per territorio dà
+    // esattamente le stesse facce (nello stesso ordine) dello scan dell'intera griglia.
+    const int16 HeightThresholdQ = FVoxelGrid::QuantizeHeight(Configuration->HeightDifferenceThreshold);
+
+    const int16* Territory = VoxelGrid.Territory.GetData();
+    const int16* Height = VoxelGrid.Height.GetData();
+
+    // --- TOP FACES: rettangoli massimali (prima in larghezza, poi in altezza) ---
+    // Bitmap locale al bounding box: niente scritture condivise tra task
+    const int32 BoundsWidth = Bounds.Width();
+    TBitArray<> Merged(false, Bounds.Area());
+    auto LocalIndex = [&](int32 X, int32 Y)
+    {
+        return (Y - Bounds.Min.Y) * BoundsWidth + (X - Bounds.Min.X);
+    };
+
+    for (const FCellSpan& Span : Spans)
+    {
+        const int32 Y = Span.Y;
+        for (int32 X = Span.X0; X < Span.X1; X++)
+        {
+            if (Merged[LocalIndex(X, Y)]) continue;
+
+            const int16 HeightQ = Height[Y * GridSizeX + X];
+            auto CanMerge = [&](int32 CX, int32 CY)
+            {
+                const int32 Idx = CY * GridSizeX + CX;
+                return Territory[Idx] == TerritoryID && Height[Idx] == HeightQ && !Merged[LocalIndex(CX, CY)];
+            };
+
+            int32 W = 1;
+            while (X + W < Span.X1 && CanMerge(X + W, Y)) W++;
+
+            int32 H = 1;
+            while (Y + H < Bounds.Max.Y)
+            {
+                bool bRowMatches = true;
+                for (int32 i = 0; i < W && bRowMatches; i++)
+                {
+                    bRowMatches = CanMerge(X + i, Y + H);
+                }
+                if (!bRowMatches) break;
+                H++;
+            }
+
+            for (int32 RY = 0; RY < H; RY++)
+            {
+                Merged.SetRange(LocalIndex(X, Y + RY), W, true);
+            }
+
+            Builder.AddTopFace(X, Y, X + W, Y + H, HeightQ);
+        }
+    }
+
+    // --- SIDE FACES: strisce di celle consecutive lungo il bordo, stessa altezza ---
+    // DX/DY = direzione del vicino; la striscia scorre sull'asse perpendicolare, Pos in [Begin, End).
+    auto EmitSideRuns = [&](int32 Line, int32 Begin, int32 End, int32 DX, int32 DY, uint8 NormalIndex)
+    {
+        const bool bRunAlongY = (DX != 0);
+        int32 RunStart = INDEX_NONE;
+        int16 RunHeight = 0;
+
+        // Pos == End chiude l'ultima striscia aperta
+        for (int32 Pos = Begin; Pos <= End; Pos++)
+        {
+            bool bNeedsFace = false;
+            int16 HeightQ = 0;
+
+            if (Pos < End)
+            {
+                const int32 X = bRunAlongY ? Line : Pos;
+                const int32 Y = bRunAlongY ? Pos : Line;
+                const int32 CellIdx = Y * GridSizeX + X;
+                HeightQ = Height[CellIdx];
+                bNeedsFace = Territory[CellIdx] == TerritoryID && NeedsSideFace(GetCellIndex(X + DX, Y + DY), TerritoryID, HeightQ, HeightThresholdQ);
+            }
+
+            const bool bContinuesRun = RunStart != INDEX_NONE && bNeedsFace && HeightQ == RunHeight;
+            if (bContinuesRun) continue;
+
+            if (RunStart != INDEX_NONE)
+            {
+                // Chiudi la striscia [RunStart, Pos) - stessi spigoli del per-cell, estesi alla striscia
+                if (bRunAlongY)
+                {
+                    const int32 EdgeX = (DX > 0) ? Line + 1 : Line;
+                    // Right: TR(first) -> BR(last); Left: BL(last) -> TL(first)
+                    if (DX > 0) Builder.AddSideFace(EdgeX, RunStart, EdgeX, Pos, RunHeight, NormalIndex);
+                    else        Builder.AddSideFace(EdgeX, Pos, EdgeX, RunStart, RunHeight, NormalIndex);
+                }
+                else
+                {
+                    const int32 EdgeY = (DY > 0) ? Line + 1 : Line;
+                    // Top: TL(first) -> TR(last); Bottom: BR(last) -> BL(first)
+                    if (DY > 0) Builder.AddSideFace(Pos, EdgeY, RunStart, EdgeY, RunHeight, NormalIndex);
+                    else        Builder.AddSideFace(RunStart, EdgeY, Pos, EdgeY, RunHeight, NormalIndex);
+                }
+                RunStart = INDEX_NONE;
+            }
+
+            if (bNeedsFace)
+            {
+                RunStart = Pos;
+                RunHeight = HeightQ;
+            }
+        }
+    };
+
+    // Right/Left: colonne del bounding box; Top/Bottom: le strisce non escono dagli span di riga
+    for (int32 X = Bounds.Min.X; X < Bounds.Max.X; X++) EmitSideRuns(X, Bounds.Min.Y, Bounds.Max.Y,  1,  0, FTerritoryMeshBuilder::NormalPosX); // Right (X+1)
+    for (int32 X = Bounds.Min.X; X < Bounds.Max.X; X++) EmitSideRuns(X, Bounds.Min.Y, Bounds.Max.Y, -1,  0, FTerritoryMeshBuilder::NormalNegX); // Left (X-1)
+    for (const FCellSpan& Span : Spans) EmitSideRuns(Span.Y, Span.X0, Span.X1, 0, -1, FTerritoryMeshBuilder::NormalNegY); // Top (Y-1)
+    for (const FCellSpan& Span : Spans) EmitSideRuns(Span.Y, Span.X0, Span.X1, 0,  1, FTerritoryMeshBuilder::NormalPosY); // Bottom (Y+1)
+}
+
+void AMapGenerator::GenerateMap()
+{
+    // Start timing
+    double StartTime = FPlatformTime::Seconds();
+
+    // New Voxel Entry Point
+    // Use a fixed high resolution for now (e.g., 200xAspectRatio) or exposed config
+    // New Voxel Entry Point
+    int32 BaseResolution = (Configuration) ? Configuration->GridResolution : 200;
+
+    // Auto-adjust Aspect Ratio Logic first
+    if (Configuration && Configuration->GenerationMask)
+    {
+        int32 W = Configuration->GenerationMask->GetSizeX();
+        int32 H = Configuration->GenerationMask->GetSizeY();
+        if (W > 0 && H > 0)
+        {
+            float AspectRatio = (float)H / (float)W;
+            float NewY = Configuration->MapSize.X * AspectRatio;
+            if (!FMath::IsNearlyEqual(Configuration->MapSize.Y, NewY, 1.0f))
+            {
+                Configuration->MapSize.Y = NewY;
+                UE_LOG(LogRosikoMapGen, Log, TEXT("AMapGenerator: Auto-Adjusted MapSize.Y to %f"), NewY);
+            }
+        }
+    }
+
+    GenerateVoxels(BaseResolution);
+
+    // End timing and log
+    double EndTime = FPlatformTime::Seconds();
+    double TotalTime = EndTime - StartTime;
+
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("========================================"));
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("SYNC map generation COMPLETE!"));
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("Total generation time: %.3f seconds (%.0f ms)"), TotalTime, TotalTime * 1000.0);
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("Seed: %d | Territories: %d"), MapSeed, GeneratedData.Num());
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("========================================"));
+}
+
+void AMapGenerator::GenerateVoxels(int32 GridResolution)
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenSync);
+
+    if (!Configuration || !Configuration->GenerationMask)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("Voxel Gen Aborted: Missing Config or Mask!"));
+        return;
+    }
+
+    ClearMap();
+    GeneratedData.Empty();
+    GeneratedMeshes.Empty();
+    RNG.Initialize(MapSeed);
+    LastGenerationStats = FMapGenerationStats();
+    PipelineStats = FMapGenerationStats();
+    const double GenerationStartTime = FPlatformTime::Seconds();
+
+    bLogicOnlyGeneration = ShouldGenerateLogicOnly();
+    if (bLogicOnlyGeneration)
+    {
+        UE_LOG(LogRosikoMapGen, Log, TEXT("Logic-only generation (dedicated server / no rendering): skipping geometry and territory actors"));
+    }
+
+    // 1. Setup Grid Dimensions
+    GridSizeX = GridResolution;
+    // Aspect Ratio correction for Grid Y
+    float AspectRatio = Configuration->MapSize.Y / Configuration->MapSize.X;
+    GridSizeY = FMath::RoundToInt(GridResolution * AspectRatio);
+
+    if (!PrepareGenerationInputs())
+    {
+        return;
+    }
+
+    // Cache hit: griglia, adiacenza e mesh già pronte, si salta tutta la generazione
+    if (TryLoadFromCache())
+    {
+        PipelineStats.bLoadedFromCache = true;
+        LastGenerationStats = PipelineStats;
+
+        if (bLogicOnlyGeneration)
+        {
+            ReleaseRenderData();
+            LastGenerationStats.TotalMs = MillisecondsSince(GenerationStartTime);
+            return;
+        }
+
+        const double SpawnStartTime = FPlatformTime::Seconds();
+        SpawnVisuals();
+        LastGenerationStats.SpawnMs = MillisecondsSince(SpawnStartTime);
+        LastGenerationStats.TotalMs = MillisecondsSince(GenerationStartTime);
+
+        if (Configuration->bShowDebugGlobals) DrawDebugVisuals();
+        return;
+    }
+
+    // Use Init instead of AddZeroed to ensure defaults (-1) are respected!
+    VoxelGrid.Init(GridSizeX * GridSizeY);
+
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Initializing Voxel Grid: %d x %d"), GridSizeX, GridSizeY);
+
+    // 2-3. Populate Grid (Assign Continent IDs) - parallelo per bande di righe
+    TArray<int32> CellsPerContinent;
+    const double PopulateStartTime = FPlatformTime::Seconds();
+    int32 TotalValidCells = PopulateGridContinents(CellsPerContinent);
+    PipelineStats.PopulateMs = MillisecondsSince(PopulateStartTime);
+
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Grid populated: %d valid cells over %d continents"), TotalValidCells, CellsPerContinent.Num());
+    for (int32 c = 0; c < CellsPerContinent.Num(); c++)
+    {
+        UE_LOG(LogRosikoMapGen, Verbose, TEXT("  Continent %d (%s): %d cells"), c, *Configuration->ContinentSetup[c].Name, CellsPerContinent[c]);
+    }
+
+    // 4. Territory Partitioning (Flood Fill or K-Means or Random Seeds?)
+    // User wants "Voxel Style" territories.
+    // If we just make "Continents", they will be huge.
+    // We need to split continents into Territories.
+    // SIMPLE APPROACH: Random Seeds + Voronoi ON GRID (Manhattan Distance).
+
+    // A. Generate Seeds per Continent
+    TArray<FGridSeed> Seeds;
+    const double SeedsStartTime = FPlatformTime::Seconds();
+    int32 GlobalID = GenerateTerritorySeeds(Seeds);
+    PipelineStats.SeedsMs = MillisecondsSince(SeedsStartTime);
+
+    if (GlobalID > MAX_int16)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("Voxel Gen: %d territories exceed the int16 territory plane (max %d)"), GlobalID, MAX_int16);
+        return;
+    }
+
+    // B. Grow Territories (Jump Flood, Exact Distance Transform or Brute Force)
+    const EVoronoiAlgorithm VoronoiAlgorithm = Configuration->VoronoiAlgorithm;
+    double VoronoiStartTime = FPlatformTime::Seconds();
+
+    RunVoronoi(Seeds, VoronoiAlgorithm);
+
+    PipelineStats.VoronoiMs = MillisecondsSince(VoronoiStartTime);
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("Voronoi Generation Time: %.2f ms (%s)"),
+        PipelineStats.VoronoiMs,
+        *UEnum::GetDisplayValueAsText(VoronoiAlgorithm).ToString());
+
+    // 5. Build Meshes (non in modalità solo logica: lì ci si ferma al partizionamento + adiacenza)
+    const double GeometryStartTime = FPlatformTime::Seconds();
+    InitTerritoryMetadata(Seeds);
+    BuildTerritoryAdjacency();
+    if (!bLogicOnlyGeneration)
+    {
+        BuildTerritoryGeometry();
+    }
+    PipelineStats.GeometryMs = MillisecondsSince(GeometryStartTime);
+    SaveToCache();
+
+    PipelineStats.GridMemoryKB = VoxelGrid.GetAllocatedSize() / 1024.0f;
+    UE_LOG(LogRosikoMapGen, Log, TEXT("Voxel grid memory: %.1f KB (%d cells)"),
+        PipelineStats.GridMemoryKB, VoxelGrid.Num());
+    LastGenerationStats = PipelineStats;
+
+    if (bLogicOnlyGeneration)
+    {
+        ReleaseRenderData();
+        LastGenerationStats.TotalMs = MillisecondsSince(GenerationStartTime);
+        return;
+    }
+
+    // Spawn Visuals
+    const double SpawnStartTime = FPlatformTime::Seconds();
+    SpawnVisuals();
+    LastGenerationStats.SpawnMs = MillisecondsSince(SpawnStartTime);
+    LastGenerationStats.TotalMs = MillisecondsSince(GenerationStartTime);
+
+    if (Configuration->bShowDebugGlobals) DrawDebugVisuals();
+}
+
+
+
+
+
+
+void AMapGenerator::BenchmarkVoronoiAlgorithms()
+{
+    if (!Configuration || !Configuration->GenerationMask)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("Voronoi Benchmark Aborted: Missing Config or Mask!"));
+        return;
+    }
+
+    if (AsyncState != EMapGenerationState::Idle && AsyncState != EMapGenerationState::Complete)
+    {
+        UE_LOG(LogRosikoMapGen, Warning, TEXT("Voronoi Benchmark: async generation in progress, skipping"));
+        return;
+    }
+
+    // Stessa preparazione di GenerateVoxels fino ai seed
+    ClearMap();
+    GeneratedData.Empty();
+    GeneratedMeshes.Empty();
+    RNG.Initialize(MapSeed);
+
+    GridSizeX = Configuration->GridResolution;
+    float AspectRatio = Configuration->MapSize.Y / Configuration->MapSize.X;
+    GridSizeY = FMath::RoundToInt(Configuration->GridResolution * AspectRatio);
+    if (!SnapshotGenerationMask())
+    {
+        return;
+    }
+    VoxelGrid.Init(GridSizeX * GridSizeY);
+
+    TArray<int32> CellsPerContinent;
+    const int32 TotalValidCells = PopulateGridContinents(CellsPerContinent);
+
+    TArray<FGridSeed> Seeds;
+    if (GenerateTerritorySeeds(Seeds) > MAX_int16)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("Voronoi Benchmark: too many territories for the int16 territory plane"));
+        VoxelGrid.Empty();
+        return;
+    }
+
+    // Ogni algoritmo parte dallo stesso stato (piano Territory con i soli seed, stesso RNG)
+    const TArray<int16> SeedTerritories = VoxelGrid.Territory;
+    const FRandomStream RNGAfterSeeds = RNG;
+
+    auto DistSqToSeed = [&Seeds, this](int32 CellIdx, int16 TerritoryID) -> int32
+    {
+        const FGridSeed& S = Seeds[TerritoryID];
+        return FMath::Square(S.X - CellIdx % GridSizeX) + FMath::Square(S.Y - CellIdx / GridSizeX);
+    };
+
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("=== Voronoi Benchmark: %d x %d grid, %d land cells, %d seeds ==="),
+        GridSizeX, GridSizeY, TotalValidCells, Seeds.Num());
+
+    // Il brute force gira per primo ed è il riferimento per contare gli errori
+    const EVoronoiAlgorithm Algorithms[] = { EVoronoiAlgorithm::BruteForce, EVoronoiAlgorithm::JumpFlood, EVoronoiAlgorithm::ExactDistanceTransform };
+    TArray<int16> Reference;
+
+    for (EVoronoiAlgorithm Algorithm : Algorithms)
+    {
+        VoxelGrid.Territory = SeedTerritories;
+        RNG = RNGAfterSeeds;
+
+        const double StartTime = FPlatformTime::Seconds();
+        RunVoronoi(Seeds, Algorithm);
+        const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+        if (Reference.Num() == 0)
+        {
+            Reference = VoxelGrid.Territory;
+        }
+
+        // Una cella è sbagliata se il suo seed è più lontano di quello del brute force (i pareggi vanno bene)
+        int32 WrongCells = 0;
+        for (int32 CellIdx = 0; CellIdx < VoxelGrid.Num(); CellIdx++)
+        {
+            const int16 Expected = Reference[CellIdx];
+            const int16 Actual = VoxelGrid.Territory[CellIdx];
+            if (Expected == Actual) continue;
+
+            if (Actual == -1 || Expected == -1 || DistSqToSeed(CellIdx, Actual) > DistSqToSeed(CellIdx, Expected))
+            {
+                WrongCells++;
+            }
+        }
+
+        UE_LOG(LogRosikoMapGen, Warning, TEXT("  %-28s %9.2f ms   %d cells not on nearest seed"),
+            *UEnum::GetDisplayValueAsText(Algorithm).ToString(), ElapsedMs, WrongCells);
+    }
+
+    VoxelGrid.Empty();
+}
+
+FMapCache::FKey AMapGenerator::MakeCacheKey() const
+{
+    FMapCache::FKey Key;
+    Key.Seed = MapSeed;
+    Key.ConfigHash = FMapCache::HashConfiguration(*Configuration, MaskTexels, MaskSizeX);
+    Key.GeneratorVersion = GeneratorVersion;
+    return Key;
+}
+
+bool AMapGenerator::PrepareGenerationInputs()
+{
+    if (!SnapshotGenerationMask())
     {
-        UsedNamesPerContinent.Add(c, TArray<FString>());
+        return false;
     }
 
-    // Init Basic Info
-    for(const FGridSeed& S : Seeds)
+    // Le altezze oltre il range quantizzato verrebbero troncate in silenzio (i ClampMax valgono solo nell'editor)
+    const float MaxAbsHeight =
+        FMath::Max(FMath::Abs(Configuration->TerritoryHeightRange.X), FMath::Abs(Configuration->TerritoryHeightRange.Y)) +
+        FMath::Max(FMath::Abs(Configuration->CellHeightRange.X), FMath::Abs(Configuration->CellHeightRange.Y));
+    if (MaxAbsHeight > FVoxelGrid::MaxHeight)
     {
-        if (S.ID < GeneratedData.Num())
-        {
-            GeneratedData[S.ID].ID = S.ID;
-            GeneratedData[S.ID].ContinentID = S.ContIndex;
-
-            FLinearColor BaseColor = Configuration->ContinentSetup[S.ContIndex].Color;
-            GeneratedData[S.ID].DebugColor = BaseColor;
+        UE_LOG(LogRosikoMapGen, Warning, TEXT("TerritoryHeightRange + CellHeightRange reach %.2f, heights will be clamped to +/- %.2f"),
+               MaxAbsHeight, FVoxelGrid::MaxHeight);
+    }
 
-            // Generate territory-specific color variation (darker shade)
-            float BrightnessMultiplier = RNG.FRandRange(Configuration->TerritoryBrightnessRange.X, Configuration->TerritoryBrightnessRange.Y);
-            FLinearColor TerritoryColor = BaseColor * BrightnessMultiplier;
-            TerritoryColor.A = 1.0f; // Preserve alpha
-            GeneratedData[S.ID].TerritoryColor = TerritoryColor;
+    CacheKey = MakeCacheKey();
+    return true;
+}
 
-            GeneratedData[S.ID].bIsOcean = false;
+bool AMapGenerator::SnapshotGenerationMask()
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenMaskSnapshot);
 
-            // Assegna un nome random dal pool del continente
-            const FContinentDefinition& Continent = Configuration->ContinentSetup[S.ContIndex];
-            FString TerritoryName;
+    MaskTexels.Empty();
+    MaskSizeX = 0;
+    MaskSizeY = 0;
 
-            if (Continent.TerritoryNames.Num() > 0)
-            {
-                // Crea un pool di nomi disponibili (non ancora usati)
-                TArray<FString> AvailableNames;
-                for (const FString& Name : Continent.TerritoryNames)
-                {
-                    if (!UsedNamesPerContinent[S.ContIndex].Contains(Name))
-                    {
-                        AvailableNames.Add(Name);
-                    }
-                }
+    UTexture2D* Mask = Configuration->GenerationMask;
+    FTexturePlatformData* PlatformData = Mask->GetPlatformData();
+    if (!PlatformData || PlatformData->Mips.Num() == 0)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("SnapshotGenerationMask: GenerationMask has no mip data!"));
+        return false;
+    }
 
-                // Se abbiamo nomi disponibili, pescane uno random
-                if (AvailableNames.Num() > 0)
-                {
-                    int32 RandomIndex = RNG.RandRange(0, AvailableNames.Num() - 1);
-                    TerritoryName = AvailableNames[RandomIndex];
-                    UsedNamesPerContinent[S.ContIndex].Add(TerritoryName);
-                }
-                else
-                {
-                    // Se abbiamo esaurito i nomi, genera un nome con suffisso numerico
-                    int32 Suffix = UsedNamesPerContinent[S.ContIndex].Num() - Continent.TerritoryNames.Num() + 1;
-                    TerritoryName = FString::Printf(TEXT("%s %d"), *Continent.Name, Suffix);
-                    UsedNamesPerContinent[S.ContIndex].Add(TerritoryName);
-                }
-            }
-            else
-            {
-                // Fallback: genera nome generico se il continente non ha nomi definiti
-                TerritoryName = FString::Printf(TEXT("%s Territory %d"), *Continent.Name, S.ID);
-            }
+    // Copia di mip 0: le BulkData vanno lockate sul game thread, la generazione poi legge solo la copia
+    FByteBulkData& BulkData = PlatformData->Mips[0].BulkData;
+    const int32 SizeX = Mask->GetSizeX();
+    const int32 SizeY = Mask->GetSizeY();
+    const int64 NumTexels = (int64)SizeX * SizeY;
 
-            GeneratedData[S.ID].Name = TerritoryName;
+    const void* RawData = BulkData.LockReadOnly();
+    if (RawData && NumTexels > 0 && BulkData.GetBulkDataSize() >= NumTexels * (int64)sizeof(uint32))
+    {
+        MaskTexels.SetNumUninitialized((int32)NumTexels);
+        FMemory::Memcpy(MaskTexels.GetData(), RawData, NumTexels * sizeof(uint32));
+        MaskSizeX = SizeX;
+        MaskSizeY = SizeY;
+    }
+    BulkData.Unlock();
 
-            // Center calculation using seed location and height
-            float WorldX = (float)S.X / GridSizeX * (Configuration->MapSize.X*2) - Configuration->MapSize.X;
-            float WorldY = (float)S.Y / GridSizeY * (Configuration->MapSize.Y*2) - Configuration->MapSize.Y;
-            GeneratedData[S.ID].CenterPoint = FVector(WorldX, WorldY, S.BaseHeight);
-        }
+    if (MaskTexels.Num() == 0)
+    {
+        UE_LOG(LogRosikoMapGen, Error, TEXT("SnapshotGenerationMask: GenerationMask has no readable BGRA8 mip data!"));
+        return false;
     }
 
-    // Geometry Construction: "Cubes" per cell, but optimized (Face Culling)
-    // Scale Factor
-    float CellW = (Configuration->MapSize.X * 2.0f) / (float)GridSizeX;
-    float CellH = (Configuration->MapSize.Y * 2.0f) / (float)GridSizeY;
+    return true;
+}
 
-    // OPTIMIZATION: Pre-allocate memory for mesh arrays
-    // Estimate: ~16-20 vertices per cell (top + sides, no bottom)
-    int32 TotalCells = GridSizeX * GridSizeY;
-    int32 EstimatedCellsPerTerritory = (GlobalID > 0) ? (TotalCells / GlobalID) : TotalCells;
-    int32 EstimatedVerticesPerTerritory = EstimatedCellsPerTerritory * 20;
-    int32 EstimatedTrianglesPerTerritory = EstimatedVerticesPerTerritory * 2;
+bool AMapGenerator::TryLoadFromCache()
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenCacheLoad);
 
-    for(FGeneratedTerritory& Data : GeneratedData)
+    if (!Configuration->bUseMapCache) return false;
+
+    const double StartTime = FPlatformTime::Seconds();
+    const bool bLoaded = FMapCache::Load(CacheKey, [this](FArchive& Ar) { return SerializeCachedMap(Ar); });
+
+    if (!bLoaded)
     {
-        Data.Vertices.Reserve(EstimatedVerticesPerTerritory);
-        Data.Normals.Reserve(EstimatedVerticesPerTerritory);
-        Data.VertexColors.Reserve(EstimatedVerticesPerTerritory);
-        Data.Triangles.Reserve(EstimatedTrianglesPerTerritory);
+        // Un payload letto a metà non deve lasciare dati parziali
+        GeneratedData.Empty();
+        GeneratedMeshes.Empty();
+        VoxelGrid.Empty();
+        AdjacencyOffsets.Empty();
+        AdjacencyIndices.Empty();
+        return false;
     }
 
-    // OPTIMIZATION: Cache half-width/height calculations (eliminates ~240k multiplications)
-    float HalfW = 0.5f * CellW;
-    float HalfH = 0.5f * CellH;
+    UpdateGeometryStats();
+    PipelineStats.GridMemoryKB = VoxelGrid.GetAllocatedSize() / 1024.0f;
 
-    for (int32 Y = 0; Y < GridSizeY; Y++)
-    {
-        for (int32 X = 0; X < GridSizeX; X++)
-        {
-            FVoxelCell* Cell = GetCell(X, Y);
-            if (!Cell || Cell->TerritoryID == -1) continue;
-
-            FGeneratedTerritory& Data = GeneratedData[Cell->TerritoryID];
-
-            float WX = (float)X * CellW - Configuration->MapSize.X + HalfW; // Center of cell
-            float WY = (float)Y * CellH - Configuration->MapSize.Y + HalfH;
-
-            float CellHeight = Cell->Height; // Use dynamic height from cell
-
-            // OPTIMIZATION: Generate vertices in LOCAL space (relative to territory center)
-            // This eliminates the need to copy and transform vertices in SpawnVisuals
-            FVector TerritoryCenter = Data.CenterPoint;
-            FVector LocalBase(WX - TerritoryCenter.X, WY - TerritoryCenter.Y, -TerritoryCenter.Z);
-
-            // Vertices for TOP Face (Z=+CellHeight)
-            //   0 -- 1
-            //   |    |
-            //   2 -- 3
-            FVector TL(-HalfW, -HalfH, CellHeight);
-            FVector TR( HalfW, -HalfH, CellHeight);
-            FVector BL(-HalfW,  HalfH, CellHeight);
-            FVector BR( HalfW,  HalfH, CellHeight);
-
-            // Top Face (Z-Up)
-            int32 I = Data.Vertices.Num();
-            Data.Vertices.Add(LocalBase + TL);
-            Data.Vertices.Add(LocalBase + TR);
-            Data.Vertices.Add(LocalBase + BR);
-            Data.Vertices.Add(LocalBase + BL);
-
-            FVector UpNormal(0,0,1);
-            Data.Normals.Add(UpNormal); Data.Normals.Add(UpNormal);
-            Data.Normals.Add(UpNormal); Data.Normals.Add(UpNormal);
-
-            FLinearColor TerritoryCol = Data.TerritoryColor;
-            Data.VertexColors.Add(TerritoryCol); Data.VertexColors.Add(TerritoryCol);
-            Data.VertexColors.Add(TerritoryCol); Data.VertexColors.Add(TerritoryCol);
-
-            // Triangle 1: TL-BR-TR (inverted winding)
-            Data.Triangles.Add(I + 0);
-            Data.Triangles.Add(I + 2);
-            Data.Triangles.Add(I + 1);
-
-            // Triangle 2: TL-BL-BR (inverted winding)
-            Data.Triangles.Add(I + 0);
-            Data.Triangles.Add(I + 3);
-            Data.Triangles.Add(I + 2);
-
-            // OPTIONAL: SIDE FACES (Only if Neighbor is different, Ocean, or different height)
-            // OPTIMIZATION: Use helper function to reduce code duplication
-
-            // Check Right (X+1)
-            FVoxelCell* Right = GetCell(X + 1, Y);
-            bool bNeedRightFace = !Right || Right->TerritoryID != Cell->TerritoryID || FMath::Abs(Right->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-            if (bNeedRightFace)
-            {
-                AddQuadFace(Data, LocalBase + TR, LocalBase + BR, FVector(1,0,0), Data.TerritoryColor);
-            }
+    UE_LOG(LogRosikoMapGen, Warning, TEXT("Map loaded from cache in %.2f ms (seed %d, %d territories)"),
+        (FPlatformTime::Seconds() - StartTime) * 1000.0, MapSeed, GeneratedData.Num());
+    return true;
+}
 
-            // Check Left (X-1)
-            FVoxelCell* Left = GetCell(X - 1, Y);
-            bool bNeedLeftFace = !Left || Left->TerritoryID != Cell->TerritoryID || FMath::Abs(Left->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-            if (bNeedLeftFace)
-            {
-                AddQuadFace(Data, LocalBase + BL, LocalBase + TL, FVector(-1,0,0), Data.TerritoryColor);
-            }
+void AMapGenerator::SaveToCache()
+{
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenCacheSave);
 
-            // Check Top (Y-1)
-            FVoxelCell* Top = GetCell(X, Y - 1);
-            bool bNeedTopFace = !Top || Top->TerritoryID != Cell->TerritoryID || FMath::Abs(Top->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-            if (bNeedTopFace)
-            {
-                AddQuadFace(Data, LocalBase + TL, LocalBase + TR, FVector(0,-1,0), Data.TerritoryColor);
-            }
+    // Senza mesh il file non sarebbe valido per un client con lo stesso seed
+    if (!Configuration->bUseMapCache || bLogicOnlyGeneration) return;
 
-            // Check Bottom (Y+1)
-            FVoxelCell* Bot = GetCell(X, Y + 1);
-            bool bNeedBotFace = !Bot || Bot->TerritoryID != Cell->TerritoryID || FMath::Abs(Bot->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-            if (bNeedBotFace)
-            {
-                AddQuadFace(Data, LocalBase + BR, LocalBase + BL, FVector(0,1,0), Data.TerritoryColor);
-            }
+    FMapCache::Save(CacheKey, [this](FArchive& Ar) { return SerializeCachedMap(Ar); });
+}
+
+bool AMapGenerator::SerializeCachedMap(FArchive& Ar)
+{
+    // Raster della griglia (Continent/Territory/Height; i piani SeedIndex sono temporanei)
+    Ar << GridSizeX << GridSizeY;
+    FMapCache::SerializeRawArray(Ar, VoxelGrid.Continent);
+    FMapCache::SerializeRawArray(Ar, VoxelGrid.Territory);
+    FMapCache::SerializeRawArray(Ar, VoxelGrid.Height);
+
+    // Grafo di adiacenza CSR
+    FMapCache::SerializeRawArray(Ar, AdjacencyOffsets);
+    FMapCache::SerializeRawArray(Ar, AdjacencyIndices);
+
+    // Metadati + mesh per territorio
+    int32 NumTerritories = GeneratedData.Num();
+    Ar << NumTerritories;
+    if (Ar.IsLoading())
+    {
+        const int32 NumCells = GridSizeX * GridSizeY;
+        if (Ar.IsError() || NumTerritories < 0 || NumTerritories > MAX_int16 + 1
+            || VoxelGrid.Territory.Num() != NumCells || VoxelGrid.Height.Num() != NumCells || VoxelGrid.Continent.Num() != NumCells
+            || AdjacencyOffsets.Num() != NumTerritories + 1)
+        {
+            return false;
         }
+        GeneratedData.SetNum(NumTerritories);
+        GeneratedMeshes.SetNum(NumTerritories);
+    }
+    else if (GeneratedMeshes.Num() != NumTerritories)
+    {
+        return false;
     }
 
-    // Spawn Visuals
-    SpawnVisuals();
-    if (Configuration->bShowDebugGlobals) DrawDebugVisuals();
-}
+    for (int32 TerritoryIndex = 0; TerritoryIndex < NumTerritories; TerritoryIndex++)
+    {
+        FGeneratedTerritory& Data = GeneratedData[TerritoryIndex];
+        FGeneratedTerritoryMesh& Mesh = GeneratedMeshes[TerritoryIndex];
+
+        Ar << Data.ID << Data.Name << Data.bIsOcean << Data.ContinentID;
+        Ar << Data.CenterPoint << Data.DebugColor << Data.TerritoryColor;
+        FMapCache::SerializeRawArray(Ar, Mesh.Vertices);
+        FMapCache::SerializeRawArray(Ar, Mesh.Triangles);
+        FMapCache::SerializeRawArray(Ar, Mesh.Normals);
+        FMapCache::SerializeRawArray(Ar, Mesh.VertexColors);
+        FMapCache::SerializeRawArray(Ar, Data.NeighborIDs);
+
+        if (Ar.IsError()) return false;
+    }
 
+    return !Ar.IsError();
+}
 
+bool AMapGenerator::ShouldGenerateLogicOnly() const
+{
+    // -nullrhi (o commandlet/server senza rendering): nessuno vedrà le mesh
+    return bAllowLogicOnlyGeneration && (IsRunningDedicatedServer() || !FApp::CanEverRender());
+}
 
+void AMapGenerator::ReleaseRenderData()
+{
+    // Al server servono solo ID, continenti, centri e adiacenza: griglia e buffer mesh si liberano
+    VoxelGrid.Empty();
+    ReleaseTerritoryMeshes();
 
+    UpdateGeometryStats();
+}
 
+void AMapGenerator::ReleaseTerritoryMeshes()
+{
+    GeneratedMeshes.Empty();
+    SET_MEMORY_STAT(STAT_RosikoTerritoryMeshMemory, 0);
+}
 
 void AMapGenerator::ClearMap()
 {
+    // Un task ancora in corso scriverebbe su dati che stiamo per azzerare
+    StopGenerationTask();
+
     // Pulisci linee di debug persistenti precedenti
     FlushPersistentDebugLines(GetWorld());
 
@@ -708,10 +1952,15 @@ void AMapGenerator::ClearMap()
         }
     }
     SpawnedTerritories.Empty();
+
+    AdjacencyOffsets.Empty();
+    AdjacencyIndices.Empty();
 }
 
 void AMapGenerator::DrawDebugVisuals()
 {
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenDebugVisuals);
+
     if (!Configuration)
     {
         UE_LOG(LogRosikoMapGen, Warning, TEXT("DrawDebugVisuals: Configuration is null"));
@@ -806,6 +2055,8 @@ void AMapGenerator::DrawDebugVisuals()
 
 void AMapGenerator::SpawnVisuals()
 {
+    ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenSpawn);
+
     if (!Configuration || !Configuration->TerritoryClass)
     {
         UE_LOG(LogRosikoMapGen, Warning, TEXT("AMapGenerator::SpawnVisuals: Configuration or TerritoryClass is not set!"));
@@ -816,27 +2067,51 @@ void AMapGenerator::SpawnVisuals()
     // Qui spawniamo e basta.
 
 
-    for (const FGeneratedTerritory& Data : GeneratedData)
+    for (int32 TerritoryIndex = 0; TerritoryIndex < GeneratedData.Num(); TerritoryIndex++)
     {
-        // Non spawnare mesh per l'oceano
-        if (Data.bIsOcean) continue;
+        SpawnTerritoryActor(TerritoryIndex);
+    }
+
+    // Le mesh ora vivono solo nei ProceduralMeshComponent
+    ReleaseTerritoryMeshes();
+}
 
-        FTransform SpawnTransform(FRotator::ZeroRotator, Data.CenterPoint);
-        ATerritoryActor* NewActor = GetWorld()->SpawnActor<ATerritoryActor>(Configuration->TerritoryClass, SpawnTransform);
+void AMapGenerator::SpawnTerritoryActor(int32 TerritoryIndex)
+{
+    const FGeneratedTerritory& Data = GeneratedData[TerritoryIndex];
+    FGeneratedTerritoryMesh& Mesh = GeneratedMeshes[TerritoryIndex];
 
-        if (NewActor)
-        {
-            // Imposta i dati del territorio (per logica di gioco e UI)
-            NewActor->SetTerritoryData(Data);
+    // Non spawnare mesh per l'oceano (ma liberiamo comunque la sua geometria)
+    if (Data.bIsOcean)
+    {
+        Mesh = FGeneratedTerritoryMesh();
+        return;
+    }
+
+    FTransform SpawnTransform(FRotator::ZeroRotator, Data.CenterPoint);
+    ATerritoryActor* NewActor = GetWorld()->SpawnActor<ATerritoryActor>(Configuration->TerritoryClass, SpawnTransform);
+
+    if (NewActor)
+    {
+        // Imposta i dati del territorio (per logica di gioco e UI)
+        NewActor->SetTerritoryData(Data);
+
+        // Vertici già in spazio locale: il componente copia gli array nel proprio formato (FProcMeshVertex)
+        NewActor->UploadMesh(Mesh);
 
-            // OPTIMIZATION: Vertices are already in local space, pass directly without copy
-            // This eliminates allocation + transformation of 10k-50k vertices
-            NewActor->InitializeMesh(Data);
+        // Setup visivo lato Blueprint (materiali, ecc.)
+        NewActor->InitializeMesh(Data);
 
-            // Tracciamo l'actor
-            SpawnedTerritories.Add(NewActor);
+        // Tracciamo l'actor (e lo rendiamo trovabile per ID in O(1))
+        SpawnedTerritories.Add(NewActor);
+        if (UTerritoryRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UTerritoryRegistrySubsystem>())
+        {
+            Registry->RegisterTerritory(NewActor);
         }
     }
+
+    // Il componente ha la sua copia: liberiamo subito il payload generato
+    Mesh = FGeneratedTerritoryMesh();
 }
 
 // ============================================================================
@@ -873,15 +2148,24 @@ void AMapGenerator::GenerateMapAsync()
 		}
 	}
 
-	// Reset state
+	// Reset state (ClearMap aspetta anche un eventuale task precedente)
 	ClearMap();
 	GeneratedData.Empty();
+	GeneratedMeshes.Empty();
 	RNG.Initialize(MapSeed);
+	AsyncSeeds.Empty();
+	LastGenerationStats = FMapGenerationStats();
+	PipelineStats = FMapGenerationStats();
+	bLogicOnlyGeneration = ShouldGenerateLogicOnly();
+
+	// Tutto ciò che legge la texture va fatto qui, sul game thread
+	if (!PrepareGenerationInputs())
+	{
+		return;
+	}
+
 	AsyncState = EMapGenerationState::Initializing;
 	AsyncProgress = 0.0f;
-	AsyncCurrentStep = 0;
-	AsyncSeeds.Empty();
-	AsyncUsedNamesPerContinent.Empty();
 
 	// Start timing
 	AsyncStartTime = FPlatformTime::Seconds();
@@ -889,6 +2173,14 @@ void AMapGenerator::GenerateMapAsync()
 
 	UE_LOG(LogRosikoMapGen, Log, TEXT("Starting ASYNC map generation with seed %d"), MapSeed);
 	UpdateAsyncProgress(0.0f, TEXT("Initializing..."));
+
+	// Configuration non va modificata finché il task non ha finito
+	bCancelRequested = false;
+	TaskGenerationId = ++AsyncGenerationId;
+	GenerationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+	{
+		RunGenerationPipeline();
+	});
 }
 
 void AMapGenerator::CancelAsyncGeneration()
@@ -896,47 +2188,140 @@ void AMapGenerator::CancelAsyncGeneration()
 	if (AsyncState != EMapGenerationState::Idle && AsyncState != EMapGenerationState::Complete)
 	{
 		UE_LOG(LogRosikoMapGen, Warning, TEXT("Async generation canceled"));
+
+		// Il worker si ferma al prossimo controllo; i suoi messaggi ancora in coda vengono scartati
+		bCancelRequested = true;
+		AsyncGenerationId++;
+
+		// Fino al join il worker scrive ancora griglia, GeneratedData, mesh e adiacenza:
+		// si torna Idle (e quei dati tornano leggibili) solo dopo averlo atteso
+		if (GenerationTask.IsValid())
+		{
+			GenerationTask.Wait();
+			GenerationTask = UE::Tasks::FTask();
+		}
+
 		AsyncState = EMapGenerationState::Idle;
 		AsyncProgress = 0.0f;
 		UpdateAsyncProgress(0.0f, TEXT("Canceled"));
 	}
 }
 
-void AMapGenerator::ProcessAsyncTick()
+void AMapGenerator::StopGenerationTask()
 {
-	switch (AsyncState)
+	if (!GenerationTask.IsValid())
 	{
-		case EMapGenerationState::Initializing:
-			AsyncStep_Initialize();
-			break;
+		return;
+	}
 
-		case EMapGenerationState::PopulatingGrid:
-			AsyncStep_PopulateGrid();
-			break;
+	if (!GenerationTask.IsCompleted())
+	{
+		CancelAsyncGeneration();
+	}
 
-		case EMapGenerationState::GeneratingSeeds:
-			AsyncStep_GenerateSeeds();
-			break;
+	// Task ancora attivo con stato già Idle/Complete: si ferma e si aspetta comunque
+	if (GenerationTask.IsValid())
+	{
+		bCancelRequested = true;
+		GenerationTask.Wait();
+	}
 
-		case EMapGenerationState::VoronoiPass:
-			AsyncStep_VoronoiIteration();
-			break;
+	GenerationTask = UE::Tasks::FTask();
+}
 
-		case EMapGenerationState::BuildingGeometry:
-			AsyncStep_BuildGeometry();
-			break;
+void AMapGenerator::ProcessAsyncTick()
+{
+	// Gli stage fino alla geometria girano su GenerationTask: qui resta solo lo spawn a chunk
+	if (AsyncState == EMapGenerationState::SpawningVisuals)
+	{
+		AsyncStep_SpawnVisuals();
+	}
+}
 
-		case EMapGenerationState::SpawningVisuals:
-			AsyncStep_SpawnVisuals();
-			break;
+void AMapGenerator::RunGenerationPipeline()
+{
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenPipeline);
 
-		default:
-			break;
+	// Cache hit: griglia, adiacenza e mesh già pronte, si passa direttamente allo spawn
+	if (TryLoadFromCache())
+	{
+		PipelineStats.bLoadedFromCache = true;
+		if (bLogicOnlyGeneration)
+		{
+			ReleaseRenderData();
+		}
+		ReportAsyncProgress(EMapGenerationState::SpawningVisuals, 0.8f, TEXT("Map loaded from cache, spawning territories..."), PipelineStats);
+		return;
+	}
+
+	AsyncStep_Initialize();
+	if (IsPipelineCanceled()) return;
+
+	double StageStartTime = FPlatformTime::Seconds();
+	AsyncStep_PopulateGrid();
+	PipelineStats.PopulateMs = MillisecondsSince(StageStartTime);
+	if (IsPipelineCanceled()) return;
+
+	StageStartTime = FPlatformTime::Seconds();
+	if (!AsyncStep_GenerateSeeds())
+	{
+		RunOnGameThreadIfCurrent([](AMapGenerator& Self)
+		{
+			Self.CancelAsyncGeneration();
+		});
+		return;
 	}
+	PipelineStats.SeedsMs = MillisecondsSince(StageStartTime);
+	if (IsPipelineCanceled()) return;
+
+	StageStartTime = FPlatformTime::Seconds();
+	AsyncStep_Voronoi();
+	PipelineStats.VoronoiMs = MillisecondsSince(StageStartTime);
+	if (IsPipelineCanceled()) return;
+
+	AsyncStep_BuildGeometry();
+}
+
+void AMapGenerator::RunOnGameThreadIfCurrent(TUniqueFunction<void(AMapGenerator&)> Func)
+{
+	TWeakObjectPtr<AMapGenerator> WeakThis(this);
+	const int32 GenerationId = TaskGenerationId;
+
+	AsyncTask(ENamedThreads::GameThread, [WeakThis, GenerationId, Func = MoveTemp(Func)]() mutable
+	{
+		AMapGenerator* Self = WeakThis.Get();
+		if (Self && Self->AsyncGenerationId == GenerationId)
+		{
+			Func(*Self);
+		}
+	});
+}
+
+void AMapGenerator::ReportAsyncProgress(EMapGenerationState NewState, float NewProgress, const FString& StatusText,
+                                        TOptional<FMapGenerationStats> PublishedStats)
+{
+	// AsyncState, LastGenerationStats e i delegate si toccano solo dal game thread
+	RunOnGameThreadIfCurrent([NewState, NewProgress, StatusText, PublishedStats = MoveTemp(PublishedStats)](AMapGenerator& Self)
+	{
+		if (PublishedStats.IsSet())
+		{
+			Self.LastGenerationStats = PublishedStats.GetValue();
+		}
+
+		if (NewState == EMapGenerationState::SpawningVisuals)
+		{
+			Self.AsyncCurrentSpawnIndex = 0;
+		}
+
+		Self.AsyncState = NewState;
+		Self.UpdateAsyncProgress(NewProgress, StatusText);
+	});
 }
 
 void AMapGenerator::UpdateAsyncProgress(float NewProgress, const FString& StatusText)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenProgressBroadcast);
+
 	AsyncProgress = FMath::Clamp(NewProgress, 0.0f, 1.0f);
 	OnGenerationProgress.Broadcast(AsyncProgress, StatusText);
 
@@ -945,10 +2330,13 @@ void AMapGenerator::UpdateAsyncProgress(float NewProgress, const FString& Status
 
 void AMapGenerator::CompleteAsyncGeneration()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenProgressBroadcast);
+
 	AsyncState = EMapGenerationState::Complete;
 	AsyncEndTime = FPlatformTime::Seconds();
 
 	double TotalTime = AsyncEndTime - AsyncStartTime;
+	LastGenerationStats.TotalMs = (float)(TotalTime * 1000.0);
 
 	UpdateAsyncProgress(1.0f, TEXT("Complete!"));
 	OnGenerationComplete.Broadcast();
@@ -968,422 +2356,126 @@ void AMapGenerator::AsyncStep_Initialize()
 	float AspectRatio = Configuration->MapSize.Y / Configuration->MapSize.X;
 	GridSizeY = FMath::RoundToInt(BaseResolution * AspectRatio);
 
-	VoxelGrid.Empty();
-	VoxelGrid.Init(FVoxelCell(), GridSizeX * GridSizeY);
+	VoxelGrid.Init(GridSizeX * GridSizeY);
 
 	UE_LOG(LogRosikoMapGen, Log, TEXT("Async: Grid initialized %d x %d"), GridSizeX, GridSizeY);
 
-	AsyncState = EMapGenerationState::PopulatingGrid;
-	UpdateAsyncProgress(0.1f, TEXT("Grid initialized"));
+	ReportAsyncProgress(EMapGenerationState::PopulatingGrid, 0.1f, TEXT("Grid initialized"));
 }
 
 void AMapGenerator::AsyncStep_PopulateGrid()
 {
-	// Texture Sampling Access
-	FTexture2DMipMap* Mip = &Configuration->GenerationMask->GetPlatformData()->Mips[0];
-	const uint8* RawData = (const uint8*)Mip->BulkData.LockReadOnly();
-	int32 TexSizeX = Configuration->GenerationMask->GetSizeX();
-	int32 TexSizeY = Configuration->GenerationMask->GetSizeY();
-
-	auto GetColorAtUV = [&](float U, float V) -> FLinearColor {
-		int32 X = FMath::Clamp(FMath::RoundToInt(U * (TexSizeX - 1)), 0, TexSizeX - 1);
-		int32 Y = FMath::Clamp(FMath::RoundToInt(V * (TexSizeY - 1)), 0, TexSizeY - 1);
-		int32 Index = (Y * TexSizeX + X) * 4;
-		return FLinearColor(RawData[Index + 2] / 255.0f, RawData[Index + 1] / 255.0f, RawData[Index + 0] / 255.0f, 1.0f);
-	};
+	// Populate grid (parallelo per bande di righe, stesso risultato della versione seriale)
+	TArray<int32> CellsPerContinent;
+	PopulateGridContinents(CellsPerContinent);
 
-	// Auto-detect ocean color
-	FLinearColor AutoOceanColor = FLinearColor(RawData[2] / 255.0f, RawData[1] / 255.0f, RawData[0] / 255.0f, 1.0f);
-
-	// Pre-cache continent colors
-	TArray<FVector> ContinentColorsVec;
-	for(const FContinentDefinition& Cont : Configuration->ContinentSetup)
-	{
-		ContinentColorsVec.Add(FVector(Cont.Color.R, Cont.Color.G, Cont.Color.B));
-	}
+	ReportAsyncProgress(EMapGenerationState::GeneratingSeeds, 0.3f, TEXT("Continents assigned"));
+}
 
-	FVector ConfigOceanVec(Configuration->OceanColor.R, Configuration->OceanColor.G, Configuration->OceanColor.B);
-	FVector AutoOceanVec(AutoOceanColor.R, AutoOceanColor.G, AutoOceanColor.B);
+bool AMapGenerator::AsyncStep_GenerateSeeds()
+{
+	// Generate territory seeds (same as sync version)
+	int32 GlobalID = GenerateTerritorySeeds(AsyncSeeds);
 
-	// Populate grid (all at once - fast enough)
-	for (int32 Y = 0; Y < GridSizeY; Y++)
+	if (GlobalID > MAX_int16)
 	{
-		for (int32 X = 0; X < GridSizeX; X++)
-		{
-			float U = (float)X / (float)GridSizeX;
-			float V = (float)Y / (float)GridSizeY;
-
-			FLinearColor Sample = GetColorAtUV(U, V);
-			FVoxelCell* Cell = GetCell(X, Y);
-
-			FVector SampleVec(Sample.R, Sample.G, Sample.B);
-
-			float DistConfigOcean = FVector::Dist(SampleVec, ConfigOceanVec);
-			float DistAutoOcean = FVector::Dist(SampleVec, AutoOceanVec);
-
-			bool bIsBlack = (Sample.R < 0.15f && Sample.G < 0.15f && Sample.B < 0.15f);
-			bool bIsWhite = (Sample.R > 0.85f && Sample.G > 0.85f && Sample.B > 0.85f);
-			bool bIsTransparent = (Sample.A < 0.2f);
-
-			if (DistConfigOcean < 0.2f || DistAutoOcean < 0.2f || bIsBlack || bIsWhite || bIsTransparent)
-			{
-				Cell->ContinentIndex = -1;
-				continue;
-			}
-
-			int32 BestCont = -1;
-			float MinDistSq = FLT_MAX;
-			float AcceptanceThresholdSq = Configuration->ContinentColorThreshold;
-
-			for (int32 c = 0; c < ContinentColorsVec.Num(); c++)
-			{
-				float DistSq = FVector::DistSquared(SampleVec, ContinentColorsVec[c]);
-				if (DistSq < MinDistSq && DistSq < AcceptanceThresholdSq)
-				{
-					MinDistSq = DistSq;
-					BestCont = c;
-				}
-			}
-
-			if (BestCont != -1)
-			{
-				Cell->ContinentIndex = BestCont;
-			}
-		}
+		UE_LOG(LogRosikoMapGen, Error, TEXT("Async: %d territories exceed the int16 territory plane (max %d)"), GlobalID, MAX_int16);
+		return false;
 	}
 
-	Mip->BulkData.Unlock();
-
-	AsyncState = EMapGenerationState::GeneratingSeeds;
-	UpdateAsyncProgress(0.3f, TEXT("Continents assigned"));
+	ReportAsyncProgress(EMapGenerationState::VoronoiPass, 0.4f, FString::Printf(TEXT("Seeds generated: %d territories"), AsyncSeeds.Num()));
+	return true;
 }
 
-void AMapGenerator::AsyncStep_GenerateSeeds()
+void AMapGenerator::AsyncStep_Voronoi()
 {
-	// Generate territory seeds (same as sync version)
-	AsyncSeeds.Empty();
-	int32 GlobalID = 0;
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenVoronoi);
 
-	for (int32 c = 0; c < Configuration->ContinentSetup.Num(); c++)
+	if (Configuration->VoronoiAlgorithm == EVoronoiAlgorithm::JumpFlood)
 	{
-		const FContinentDefinition& Cont = Configuration->ContinentSetup[c];
-		int32 TargetCount = Cont.TerritoryCount;
-
-		TArray<int32> ValidIndices;
-		for(int32 i=0; i<VoxelGrid.Num(); i++)
-		{
-			if (VoxelGrid[i].ContinentIndex == c) ValidIndices.Add(i);
-		}
+		InitJumpFlood(AsyncSeeds);
 
-		if (ValidIndices.Num() == 0) continue;
-
-		for(int32 k=0; k<TargetCount; k++)
-		{
-			if (ValidIndices.Num() == 0) break;
-
-			int32 VisitIdx = RNG.RandRange(0, ValidIndices.Num()-1);
-			int32 CellIdx = ValidIndices[VisitIdx];
-
-			int32 EX = CellIdx % GridSizeX;
-			int32 EY = CellIdx / GridSizeX;
-
-			float TerritoryBaseHeight = RNG.FRandRange(Configuration->TerritoryHeightRange.X, Configuration->TerritoryHeightRange.Y);
-
-			FGridSeed NewSeed;
-			NewSeed.ID = GlobalID++;
-			NewSeed.ContIndex = c;
-			NewSeed.X = EX;
-			NewSeed.Y = EY;
-			NewSeed.BaseHeight = TerritoryBaseHeight;
-			AsyncSeeds.Add(NewSeed);
-
-			GetCell(EX, EY)->TerritoryID = NewSeed.ID;
-		}
-	}
+		int32 MaxDimension = FMath::Max(GridSizeX, GridSizeY);
+		const int32 InitialJump = FMath::RoundUpToPowerOfTwo(MaxDimension) / 2;
 
-	// Initialize Jump Flood
-	for(const FGridSeed& S : AsyncSeeds)
-	{
-		FVoxelCell* SeedCell = GetCell(S.X, S.Y);
-		if (SeedCell)
+		// Tutti i passi di fila sul worker, con progress dopo ogni passo
+		for (int32 JumpSize = InitialJump; JumpSize >= 1; JumpSize /= 2)
 		{
-			SeedCell->ClosestSeed = &S;
-		}
-	}
+			if (IsPipelineCanceled()) return;
 
-	int32 MaxDimension = FMath::Max(GridSizeX, GridSizeY);
-	AsyncCurrentJumpSize = FMath::RoundUpToPowerOfTwo(MaxDimension) / 2;
+			RunJumpFloodPass(AsyncSeeds, JumpSize);
 
-	AsyncState = EMapGenerationState::VoronoiPass;
-	UpdateAsyncProgress(0.4f, FString::Printf(TEXT("Seeds generated: %d territories"), AsyncSeeds.Num()));
-}
+			// Calculate progress (Voronoi is 40% - 60% of total)
+			float VoronoiProgress = 1.0f - ((float)(JumpSize / 2) / (float)InitialJump);
+			float OverallProgress = 0.4f + (VoronoiProgress * 0.2f);
 
-void AMapGenerator::AsyncStep_VoronoiIteration()
-{
-	// Execute ONE Jump Flood iteration per tick
-	if (AsyncCurrentJumpSize >= 1)
-	{
-		for (int32 Y = 0; Y < GridSizeY; Y++)
-		{
-			for (int32 X = 0; X < GridSizeX; X++)
-			{
-				FVoxelCell* Cell = GetCell(X, Y);
-				if (!Cell || Cell->ContinentIndex == -1) continue;
-
-				const FGridSeed* CurrentBest = Cell->ClosestSeed;
-				float CurrentBestDistSq = FLT_MAX;
-
-				if (CurrentBest)
-				{
-					CurrentBestDistSq = (float)(FMath::Square(CurrentBest->X - X) + FMath::Square(CurrentBest->Y - Y));
-				}
-
-				for(int32 DY = -1; DY <= 1; DY++)
-				{
-					for(int32 DX = -1; DX <= 1; DX++)
-					{
-						int32 CheckX = X + DX * AsyncCurrentJumpSize;
-						int32 CheckY = Y + DY * AsyncCurrentJumpSize;
-
-						FVoxelCell* Neighbor = GetCell(CheckX, CheckY);
-						if (!Neighbor || !Neighbor->ClosestSeed) continue;
-
-						if (Neighbor->ClosestSeed->ContIndex != Cell->ContinentIndex) continue;
-
-						float DistToNeighborSeedSq = (float)(
-							FMath::Square(Neighbor->ClosestSeed->X - X) +
-							FMath::Square(Neighbor->ClosestSeed->Y - Y)
-						);
-
-						if (DistToNeighborSeedSq < CurrentBestDistSq)
-						{
-							CurrentBestDistSq = DistToNeighborSeedSq;
-							CurrentBest = Neighbor->ClosestSeed;
-						}
-					}
-				}
-
-				Cell->ClosestSeed = CurrentBest;
-			}
+			ReportAsyncProgress(EMapGenerationState::VoronoiPass, OverallProgress, FString::Printf(TEXT("Voronoi iteration (jump: %d)"), JumpSize / 2));
 		}
 
-		AsyncCurrentJumpSize /= 2;
-
-		// Calculate progress (Voronoi is 40% - 60% of total)
-		int32 MaxDimension = FMath::Max(GridSizeX, GridSizeY);
-		int32 InitialJump = FMath::RoundUpToPowerOfTwo(MaxDimension) / 2;
-		float VoronoiProgress = 1.0f - ((float)AsyncCurrentJumpSize / (float)InitialJump);
-		float OverallProgress = 0.4f + (VoronoiProgress * 0.2f);
-
-		UpdateAsyncProgress(OverallProgress, FString::Printf(TEXT("Voronoi iteration (jump: %d)"), AsyncCurrentJumpSize));
+		// Voronoi complete, assign TerritoryID and Height
+		AssignTerritoriesFromSeedIndex(AsyncSeeds);
 	}
 	else
 	{
-		// Voronoi complete, assign TerritoryID and Height
-		for (int32 Y = 0; Y < GridSizeY; Y++)
-		{
-			for (int32 X = 0; X < GridSizeX; X++)
-			{
-				FVoxelCell* Cell = GetCell(X, Y);
-				if (!Cell || Cell->ContinentIndex == -1 || !Cell->ClosestSeed) continue;
-
-				Cell->TerritoryID = Cell->ClosestSeed->ID;
-				float CellVariation = RNG.FRandRange(Configuration->CellHeightRange.X, Configuration->CellHeightRange.Y);
-				Cell->Height = Cell->ClosestSeed->BaseHeight + CellVariation;
-			}
-		}
-
-		AsyncState = EMapGenerationState::BuildingGeometry;
-		AsyncCurrentGeometryIndex = 0;
-		UpdateAsyncProgress(0.6f, TEXT("Voronoi complete, building geometry..."));
+		RunVoronoi(AsyncSeeds, Configuration->VoronoiAlgorithm);
 	}
+
+	ReportAsyncProgress(EMapGenerationState::BuildingGeometry, 0.6f, TEXT("Voronoi complete, building geometry..."));
 }
 
 void AMapGenerator::AsyncStep_BuildGeometry()
 {
-	// Build geometry for ALL territories at once (one frame)
-	// Alternative: split into chunks if too slow
-
-	GeneratedData.AddDefaulted(AsyncSeeds.Num());
-
-	// Init names tracking
-	AsyncUsedNamesPerContinent.Empty();
-	for (int32 c = 0; c < Configuration->ContinentSetup.Num(); c++)
-	{
-		AsyncUsedNamesPerContinent.Add(c, TArray<FString>());
-	}
-
-	// Init basic info
-	for(const FGridSeed& S : AsyncSeeds)
+	const double StageStartTime = FPlatformTime::Seconds();
+	InitTerritoryMetadata(AsyncSeeds);
+	BuildTerritoryAdjacency();
+	if (!bLogicOnlyGeneration)
 	{
-		if (S.ID < GeneratedData.Num())
-		{
-			GeneratedData[S.ID].ID = S.ID;
-			GeneratedData[S.ID].ContinentID = S.ContIndex;
-
-			FLinearColor BaseColor = Configuration->ContinentSetup[S.ContIndex].Color;
-			GeneratedData[S.ID].DebugColor = BaseColor;
-
-			float BrightnessMultiplier = RNG.FRandRange(Configuration->TerritoryBrightnessRange.X, Configuration->TerritoryBrightnessRange.Y);
-			FLinearColor TerritoryColor = BaseColor * BrightnessMultiplier;
-			TerritoryColor.A = 1.0f;
-			GeneratedData[S.ID].TerritoryColor = TerritoryColor;
-
-			GeneratedData[S.ID].bIsOcean = false;
-
-			// Assign name
-			const FContinentDefinition& Continent = Configuration->ContinentSetup[S.ContIndex];
-			FString TerritoryName;
-
-			if (Continent.TerritoryNames.Num() > 0)
-			{
-				TArray<FString> AvailableNames;
-				for (const FString& Name : Continent.TerritoryNames)
-				{
-					if (!AsyncUsedNamesPerContinent[S.ContIndex].Contains(Name))
-					{
-						AvailableNames.Add(Name);
-					}
-				}
-
-				if (AvailableNames.Num() > 0)
-				{
-					int32 RandomIndex = RNG.RandRange(0, AvailableNames.Num() - 1);
-					TerritoryName = AvailableNames[RandomIndex];
-					AsyncUsedNamesPerContinent[S.ContIndex].Add(TerritoryName);
-				}
-				else
-				{
-					int32 Suffix = AsyncUsedNamesPerContinent[S.ContIndex].Num() - Continent.TerritoryNames.Num() + 1;
-					TerritoryName = FString::Printf(TEXT("%s %d"), *Continent.Name, Suffix);
-					AsyncUsedNamesPerContinent[S.ContIndex].Add(TerritoryName);
-				}
-			}
-			else
-			{
-				TerritoryName = FString::Printf(TEXT("%s Territory %d"), *Continent.Name, S.ID);
-			}
-
-			GeneratedData[S.ID].Name = TerritoryName;
-
-			float WorldX = (float)S.X / GridSizeX * (Configuration->MapSize.X*2) - Configuration->MapSize.X;
-			float WorldY = (float)S.Y / GridSizeY * (Configuration->MapSize.Y*2) - Configuration->MapSize.Y;
-			GeneratedData[S.ID].CenterPoint = FVector(WorldX, WorldY, S.BaseHeight);
-		}
+		BuildTerritoryGeometry();
 	}
+	PipelineStats.GeometryMs = MillisecondsSince(StageStartTime);
+	PipelineStats.GridMemoryKB = VoxelGrid.GetAllocatedSize() / 1024.0f;
+	SaveToCache();
 
-	// Build mesh geometry
-	float CellW = (Configuration->MapSize.X * 2.0f) / (float)GridSizeX;
-	float CellH = (Configuration->MapSize.Y * 2.0f) / (float)GridSizeY;
-	float HalfW = 0.5f * CellW;
-	float HalfH = 0.5f * CellH;
-
-	for (int32 Y = 0; Y < GridSizeY; Y++)
+	if (bLogicOnlyGeneration)
 	{
-		for (int32 X = 0; X < GridSizeX; X++)
-		{
-			FVoxelCell* Cell = GetCell(X, Y);
-			if (!Cell || Cell->TerritoryID == -1) continue;
-
-			FGeneratedTerritory& Data = GeneratedData[Cell->TerritoryID];
-
-			float WX = (float)X * CellW - Configuration->MapSize.X + HalfW;
-			float WY = (float)Y * CellH - Configuration->MapSize.Y + HalfH;
-			float CellHeight = Cell->Height;
-
-			FVector TerritoryCenter = Data.CenterPoint;
-			FVector LocalBase(WX - TerritoryCenter.X, WY - TerritoryCenter.Y, -TerritoryCenter.Z);
-
-			// Top face
-			FVector TL(-HalfW, -HalfH, CellHeight);
-			FVector TR( HalfW, -HalfH, CellHeight);
-			FVector BL(-HalfW,  HalfH, CellHeight);
-			FVector BR( HalfW,  HalfH, CellHeight);
-
-			int32 I = Data.Vertices.Num();
-			Data.Vertices.Add(LocalBase + TL);
-			Data.Vertices.Add(LocalBase + TR);
-			Data.Vertices.Add(LocalBase + BR);
-			Data.Vertices.Add(LocalBase + BL);
-
-			FVector UpNormal(0,0,1);
-			Data.Normals.Add(UpNormal); Data.Normals.Add(UpNormal);
-			Data.Normals.Add(UpNormal); Data.Normals.Add(UpNormal);
-
-			FLinearColor TerritoryCol = Data.TerritoryColor;
-			Data.VertexColors.Add(TerritoryCol); Data.VertexColors.Add(TerritoryCol);
-			Data.VertexColors.Add(TerritoryCol); Data.VertexColors.Add(TerritoryCol);
-
-			Data.Triangles.Add(I + 0);
-			Data.Triangles.Add(I + 2);
-			Data.Triangles.Add(I + 1);
-
-			Data.Triangles.Add(I + 0);
-			Data.Triangles.Add(I + 3);
-			Data.Triangles.Add(I + 2);
-
-			// Side faces
-			FVoxelCell* Right = GetCell(X + 1, Y);
-			bool bNeedRightFace = !Right || Right->TerritoryID != Cell->TerritoryID || FMath::Abs(Right->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-			if (bNeedRightFace)
-			{
-				AddQuadFace(Data, LocalBase + TR, LocalBase + BR, FVector(1,0,0), Data.TerritoryColor);
-			}
-
-			FVoxelCell* Left = GetCell(X - 1, Y);
-			bool bNeedLeftFace = !Left || Left->TerritoryID != Cell->TerritoryID || FMath::Abs(Left->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-			if (bNeedLeftFace)
-			{
-				AddQuadFace(Data, LocalBase + BL, LocalBase + TL, FVector(-1,0,0), Data.TerritoryColor);
-			}
-
-			FVoxelCell* Top = GetCell(X, Y - 1);
-			bool bNeedTopFace = !Top || Top->TerritoryID != Cell->TerritoryID || FMath::Abs(Top->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-			if (bNeedTopFace)
-			{
-				AddQuadFace(Data, LocalBase + TL, LocalBase + TR, FVector(0,-1,0), Data.TerritoryColor);
-			}
-
-			FVoxelCell* Bot = GetCell(X, Y + 1);
-			bool bNeedBotFace = !Bot || Bot->TerritoryID != Cell->TerritoryID || FMath::Abs(Bot->Height - CellHeight) > Configuration->HeightDifferenceThreshold;
-			if (bNeedBotFace)
-			{
-				AddQuadFace(Data, LocalBase + BR, LocalBase + BL, FVector(0,1,0), Data.TerritoryColor);
-			}
-		}
+		ReleaseRenderData();
 	}
 
-	AsyncState = EMapGenerationState::SpawningVisuals;
-	AsyncCurrentSpawnIndex = 0;
-	UpdateAsyncProgress(0.8f, TEXT("Geometry built, spawning territories..."));
+	// Ultimo messaggio del worker: da qui GeneratedData e le statistiche sono del game thread
+	ReportAsyncProgress(EMapGenerationState::SpawningVisuals, 0.8f, TEXT("Geometry built, spawning territories..."), PipelineStats);
 }
 
 void AMapGenerator::AsyncStep_SpawnVisuals()
 {
-	// Spawn territories in chunks (e.g., 10 per frame)
-	const int32 TerritoriesPerFrame = 10;
-	int32 EndIndex = FMath::Min(AsyncCurrentSpawnIndex + TerritoriesPerFrame, GeneratedData.Num());
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoMapGenSpawn);
 
-	for (int32 i = AsyncCurrentSpawnIndex; i < EndIndex; i++)
+	// Solo logica: nessun TerritoryActor da spawnare
+	if (bLogicOnlyGeneration)
 	{
-		const FGeneratedTerritory& Data = GeneratedData[i];
+		CompleteAsyncGeneration();
+		return;
+	}
 
-		if (Data.bIsOcean) continue;
+	// Spawn a budget di tempo: si riprende da AsyncCurrentSpawnIndex e si va avanti finché
+	// non si esauriscono i ms del frame (almeno un territorio per frame, per garantire avanzamento)
+	const double BudgetSeconds = Configuration->GenerationFrameBudgetMs / 1000.0;
+	const double FrameStartTime = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		LastGenerationStats.SpawnMs += MillisecondsSince(FrameStartTime);
+	};
 
-		FTransform SpawnTransform(FRotator::ZeroRotator, Data.CenterPoint);
-		ATerritoryActor* NewActor = GetWorld()->SpawnActor<ATerritoryActor>(Configuration->TerritoryClass, SpawnTransform);
+	while (AsyncCurrentSpawnIndex < GeneratedData.Num())
+	{
+		SpawnTerritoryActor(AsyncCurrentSpawnIndex++);
 
-		if (NewActor)
+		if (FPlatformTime::Seconds() - FrameStartTime >= BudgetSeconds)
 		{
-			NewActor->SetTerritoryData(Data);
-			NewActor->InitializeMesh(Data);
-			SpawnedTerritories.Add(NewActor);
+			break;
 		}
 	}
 
-	AsyncCurrentSpawnIndex = EndIndex;
-
-	float SpawnProgress = (float)AsyncCurrentSpawnIndex / (float)GeneratedData.Num();
+	float SpawnProgress = GeneratedData.Num() > 0 ? (float)AsyncCurrentSpawnIndex / (float)GeneratedData.Num() : 1.0f;
 	float OverallProgress = 0.8f + (SpawnProgress * 0.2f);
 
 	UpdateAsyncProgress(OverallProgress, FString::Printf(TEXT("Spawning: %d/%d"), AsyncCurrentSpawnIndex, GeneratedData.Num()));
@@ -1391,6 +2483,8 @@ void AMapGenerator::AsyncStep_SpawnVisuals()
 	// Check if done
 	if (AsyncCurrentSpawnIndex >= GeneratedData.Num())
 	{
+		ReleaseTerritoryMeshes();
+
 		// Draw debug visuals (if enabled)
 		if (Configuration->bShowDebugGlobals)
 		{
@@ -4,8 +4,13 @@
 #include "GameFramework/Actor.h"
 #include "MapDataStructs.h"
 #include "ProceduralMeshComponent.h"
+#include "MapCache.h"
+#include "Tasks/Task.h"
+#include <atomic>
 #include "MapGenerator.generated.h"
 
+enum class EVoronoiAlgorithm : uint8;
+
 UENUM(BlueprintType)
 enum class EMapGenerationState : uint8
 {
@@ -27,6 +32,10 @@ class ROSIKO_API AMapGenerator : public AActor
 public:
     AMapGenerator();
 
+    // Versione dell'output del generatore: incrementare quando, a parità di seed e config,
+    // la mappa generata cambia (invalida la cache su disco).
+    static constexpr uint32 GeneratorVersion = 2;
+
 protected:
     virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
@@ -40,15 +49,21 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "01_Config")
     class UMapGenerationConfig* Configuration;
 
+    // Su dedicated server o senza rendering (-nullrhi) genera solo i dati logici (niente mesh e actor).
+    // Disattivare per i benchmark headless che devono misurare anche geometria e spawn.
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "01_Config")
+    bool bAllowLogicOnlyGeneration = true;
+
     // Funzione principale che avvia tutto (VOXEL MODE) - SINCRONA (blocca tutto)
     UFUNCTION(BlueprintCallable, CallInEditor, Category = "00_Commands")
     void GenerateMap();
 
-    // Generazione ASINCRONA (tick-based, con progress events) - CONSIGLIATO per gameplay
+    // Generazione ASINCRONA (griglia, seed, Voronoi e geometria su un task in background;
+    // spawn degli actor a chunk sul game thread, con progress events) - CONSIGLIATO per gameplay
     UFUNCTION(BlueprintCallable, Category = "00_Commands")
     void GenerateMapAsync();
 
-    // Cancella generazione asincrona in corso
+    // Cancella generazione asincrona in corso (attende la fine del worker prima di tornare Idle)
     UFUNCTION(BlueprintCallable, Category = "00_Commands")
     void CancelAsyncGeneration();
 
@@ -56,10 +71,30 @@ public:
     UFUNCTION(BlueprintCallable, CallInEditor, Category = "00_Commands")
     void ClearMap();
 
+    // Confronta i tempi di JumpFlood, BruteForce e Exact Distance Transform sulla stessa griglia
+    // (stesso seed e stessi seed territorio). Logga ms e celle non assegnate al seed più vicino.
+    UFUNCTION(CallInEditor, Category = "00_Commands")
+    void BenchmarkVoronoiAlgorithms();
+
     // Ottieni i dati dei territori generati (per GameManager)
     UFUNCTION(BlueprintPure, Category = "Map Data")
     const TArray<FGeneratedTerritory>& GetGeneratedTerritories() const { return GeneratedData; }
 
+    // Tempi per stage e dimensioni dell'ultima generazione (sync o async)
+    UFUNCTION(BlueprintPure, Category = "Map Data")
+    const FMapGenerationStats& GetLastGenerationStats() const { return LastGenerationStats; }
+
+    // Vicini di un territorio (riga del grafo CSR, ordinata per ID). Vuota se l'ID non esiste.
+    TArrayView<const int32> GetTerritoryNeighbors(int32 TerritoryID) const;
+
+    // true se i due territori confinano (ricerca binaria nella riga CSR, O(log grado))
+    UFUNCTION(BlueprintPure, Category = "Map Data")
+    bool AreTerritoriesAdjacent(int32 TerritoryA, int32 TerritoryB) const;
+
+    // true se l'ultima generazione è solo logica: ID, continenti, centri e adiacenza, senza mesh né TerritoryActor
+    UFUNCTION(BlueprintPure, Category = "Map Data")
+    bool IsLogicOnlyGeneration() const { return bLogicOnlyGeneration; }
+
     // Ottieni stato generazione corrente
     UFUNCTION(BlueprintPure, Category = "Map Data")
     EMapGenerationState GetGenerationState() const { return AsyncState; }
@@ -87,6 +122,7 @@ public:
 protected:
     virtual void BeginPlay() override;
     virtual void Tick(float DeltaTime) override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
     // === REPLICATION CALLBACKS ===
@@ -106,12 +142,129 @@ private:
         float BaseHeight;
     };
 
-    struct FVoxelCell
+    // Griglia voxel in formato Structure-of-Arrays: un piano compatto per campo,
+    // tutti indicizzati con Y * GridSizeX + X. I passi di flood leggono solo i piani che servono.
+    struct FVoxelGrid
+    {
+        // Quantizzazione altezza: 1 step = 0.01 unità (range int16 = +/- 327 unità)
+        static constexpr float HeightQuantum = 0.01f;
+        static constexpr float MaxHeight = MAX_int16 * HeightQuantum;
+
+        TArray<int16> Continent;     // Indice continente, -1 = Ocean/Invalid
+        TArray<int16> Territory;     // ID univoco del territorio finale, -1 = nessuno
+        TArray<int16> Height;        // Altezza Z quantizzata (per effetto profondità)
+        TArray<int32> SeedIndex;     // JFA: indice in Seeds del seed più vicino (INDEX_NONE = nessuno)
+        TArray<int32> SeedIndexBack; // JFA: buffer di scrittura del passo corrente (ping-pong)
+
+        void Init(int32 NumCells)
+        {
+            Continent.Init(-1, NumCells);
+            Territory.Init(-1, NumCells);
+            Height.Init(QuantizeHeight(20.0f), NumCells);
+            SeedIndex.Empty();
+            SeedIndexBack.Empty();
+        }
+
+        void Empty()
+        {
+            Continent.Empty();
+            Territory.Empty();
+            Height.Empty();
+            SeedIndex.Empty();
+            SeedIndexBack.Empty();
+        }
+
+        int32 Num() const { return Continent.Num(); }
+
+        SIZE_T GetAllocatedSize() const
+        {
+            return Continent.GetAllocatedSize() + Territory.GetAllocatedSize() + Height.GetAllocatedSize()
+                + SeedIndex.GetAllocatedSize() + SeedIndexBack.GetAllocatedSize();
+        }
+
+        static FORCEINLINE int16 QuantizeHeight(float InHeight)
+        {
+            return (int16)FMath::Clamp(FMath::RoundToInt(InHeight / HeightQuantum), (int32)MIN_int16, (int32)MAX_int16);
+        }
+
+        static FORCEINLINE float DequantizeHeight(int16 InHeight)
+        {
+            return (float)InHeight * HeightQuantum;
+        }
+    };
+
+    // Classificazione colore maschera -> continente (stesse regole per il test esatto e per la LUT 5-6-5)
+    struct FContinentClassifier
     {
-        int32 ContinentIndex = -1; // -1 = Ocean/Invalid
-        int32 TerritoryID = -1;    // ID univoco del territorio finale
-        float Height = 20.0f;      // Altezza Z di questa cella (per effetto profondità)
-        const FGridSeed* ClosestSeed = nullptr; // Per Jump Flood Algorithm
+        static constexpr int32 Ambiguous = -2;     // Voce LUT: il bucket va classificato per pixel
+        static constexpr float OceanDistance = 0.2f;
+
+        TArray<FVector> ContinentColors;
+        FVector ConfigOcean = FVector::ZeroVector;
+        FVector AutoOcean = FVector::ZeroVector;
+        float AcceptanceThresholdSq = 0.0f;
+
+        // Indice continente per un colore 8-bit, -1 = Ocean/nessun continente entro soglia
+        int32 Classify(uint8 R8, uint8 G8, uint8 B8) const;
+
+        // Risultato comune a tutto il box [Lo, Hi] (byte, estremi inclusi) oppure Ambiguous
+        int32 ClassifyBox(const FIntVector& Lo, const FIntVector& Hi) const;
+
+        static FORCEINLINE int32 ToIndex565(uint8 R8, uint8 G8, uint8 B8)
+        {
+            return ((R8 >> 3) << 11) | ((G8 >> 2) << 5) | (B8 >> 3);
+        }
+    };
+
+    // Costruisce la mesh di UN territorio. Vertici indirizzati per corner di griglia:
+    // con bWeldVertices i vertici con stessa posizione, normale (e colore, unico per territorio) sono condivisi.
+    struct FTerritoryMeshBuilder
+    {
+        enum : uint8 { NormalUp = 0, NormalPosX, NormalNegX, NormalNegY, NormalPosY };
+
+        const FGeneratedTerritory& Territory; // Centro e colore
+        FGeneratedTerritoryMesh& Mesh;
+        FVector2D CellSize;
+        FVector2D Origin;                  // World XY del corner (0,0)
+        bool bWeldVertices;
+        TMap<uint64, int32> VertexLookup;  // Chiave corner -> indice in Mesh.Vertices
+
+        FTerritoryMeshBuilder(const FGeneratedTerritory& InTerritory, FGeneratedTerritoryMesh& InMesh, const FVector2D& InCellSize, const FVector2D& InOrigin, bool bInWeldVertices)
+            : Territory(InTerritory), Mesh(InMesh), CellSize(InCellSize), Origin(InOrigin), bWeldVertices(bInWeldVertices)
+        {
+        }
+
+        // Quad superiore tra i corner (X0,Y0) e (X1,Y1), all'altezza quantizzata HeightQ
+        void AddTopFace(int32 CornerX0, int32 CornerY0, int32 CornerX1, int32 CornerY1, int16 HeightQ);
+
+        // Quad laterale: spigolo superiore da corner 1 a corner 2, proiettato fino a Z locale 0
+        void AddSideFace(int32 CornerX1, int32 CornerY1, int32 CornerX2, int32 CornerY2, int16 HeightQ, uint8 NormalIndex);
+
+    private:
+        int32 AddVertex(int32 CornerX, int32 CornerY, int16 HeightQ, bool bGround, uint8 NormalIndex, const FVector& Normal);
+        static uint64 MakeVertexKey(int32 CornerX, int32 CornerY, int16 HeightQ, bool bGround, uint8 NormalIndex);
+    };
+
+    // Celle consecutive dello stesso territorio su una riga: [X0, X1)
+    struct FCellSpan
+    {
+        int32 Y;
+        int32 X0;
+        int32 X1;
+    };
+
+    // Celle raggruppate per territorio (CSR di span, ordinati per Y poi X): ogni territorio
+    // legge solo le proprie celle, quindi le mesh si costruiscono in parallelo
+    struct FTerritoryCellBuckets
+    {
+        TArray<int32> Offsets;    // Span di T in Spans[Offsets[T] .. Offsets[T+1])
+        TArray<FCellSpan> Spans;
+        TArray<FIntRect> Bounds;  // Bounding box in celle (Max esclusivo)
+
+        TArrayView<const FCellSpan> GetSpans(int32 TerritoryID) const
+        {
+            return TArrayView<const FCellSpan>(Spans.GetData() + Offsets[TerritoryID], Offsets[TerritoryID + 1] - Offsets[TerritoryID]);
+        }
     };
 
     // === MEMBER VARIABLES ===
@@ -122,12 +275,36 @@ private:
     // I dati calcolati
     TArray<FGeneratedTerritory> GeneratedData;
 
+    // Mesh per territorio (stesso indice di GeneratedData). Spostate nei TerritoryActor allo spawn
+    // e poi svuotate: dopo la generazione la geometria vive solo nelle ProceduralMeshComponent.
+    TArray<FGeneratedTerritoryMesh> GeneratedMeshes;
+
     // Teniamo traccia degli actor spawnati per poterli distruggere quando rigeneriamo
     UPROPERTY()
     TArray<class ATerritoryActor*> SpawnedTerritories;
 
-    // Griglia locale. Usiamo un array 1D mappato 2D per semplicità.
-    TArray<FVoxelCell> VoxelGrid;
+    // Grafo di adiacenza dei territori in formato CSR (Compressed Sparse Row):
+    // i vicini di T sono AdjacencyIndices[AdjacencyOffsets[T] .. AdjacencyOffsets[T+1])
+    TArray<int32> AdjacencyOffsets;
+    TArray<int32> AdjacencyIndices;
+
+    // LUT colore -> continente indicizzata RGB 5-6-5 (65536 voci). Ricostruita solo quando
+    // cambiano colori continenti, oceano o soglia (ContinentColorLUTKey).
+    TArray<int16> ContinentColorLUT;
+    uint64 ContinentColorLUTKey = 0;
+
+    // Modalità solo logica, decisa all'avvio della generazione (il worker la legge e basta)
+    bool bLogicOnlyGeneration = false;
+
+    // Statistiche dell'ultima generazione (solo game thread)
+    FMapGenerationStats LastGenerationStats;
+
+    // Statistiche in costruzione degli stage di generazione: in async sono del worker
+    // e arrivano in LastGenerationStats con il messaggio SpawningVisuals
+    FMapGenerationStats PipelineStats;
+
+    // Griglia locale (SoA). Ogni piano è un array 1D mappato 2D.
+    FVoxelGrid VoxelGrid;
     int32 GridSizeX = 0;
     int32 GridSizeY = 0;
 
@@ -139,18 +316,31 @@ private:
     // Progresso 0.0 - 1.0
     float AsyncProgress = 0.0f;
 
-    // Current step index (per generazione multi-step)
-    int32 AsyncCurrentStep = 0;
-
-    // Numero totale step
-    int32 AsyncTotalSteps = 0;
-
     // Async data (persistente tra step)
     TArray<FGridSeed> AsyncSeeds;
-    int32 AsyncCurrentJumpSize = 0;
-    int32 AsyncCurrentGeometryIndex = 0;
     int32 AsyncCurrentSpawnIndex = 0;
-    TMap<int32, TArray<FString>> AsyncUsedNamesPerContinent;
+
+    // Task in background che esegue la pipeline (cache, griglia, seed, Voronoi, geometria).
+    // Mentre è in esecuzione possiede VoxelGrid, GeneratedData, adiacenza e RNG: il game thread
+    // li tocca solo dopo il passaggio a SpawningVisuals o dopo averlo atteso.
+    UE::Tasks::FTask GenerationTask;
+
+    // Richiesta di stop controllata dal worker tra uno stage e l'altro
+    std::atomic<bool> bCancelRequested { false };
+
+    // Incrementato (game thread) a ogni avvio/cancel: i messaggi di un task vecchio vengono scartati
+    int32 AsyncGenerationId = 0;
+
+    // Id della generazione che il task sta eseguendo (scritto prima del launch, poi solo letto)
+    int32 TaskGenerationId = 0;
+
+    // Copia di mip 0 della GenerationMask (BGRA8), presa sul game thread prima di generare
+    TArray<uint32> MaskTexels;
+    int32 MaskSizeX = 0;
+    int32 MaskSizeY = 0;
+
+    // Chiave cache calcolata sul game thread (l'hash legge la texture)
+    FMapCache::FKey CacheKey;
 
     // Timing tracking
     double AsyncStartTime = 0.0;
@@ -163,32 +353,101 @@ private:
     // --- Passaggi interni (SINCRONO) ---
     void GenerateVoxels(int32 GridResolution); // New Voxel Algorithm
 
+    // Snapshot della GenerationMask + CacheKey (game thread). false se la maschera non è leggibile.
+    bool PrepareGenerationInputs();
+    bool SnapshotGenerationMask();
+
+    // Assegna ContinentIndex a ogni cella campionando lo snapshot della maschera (parallelo per bande di righe).
+    // Ritorna il numero di celle valide; OutCellsPerContinent contiene il conteggio per continente.
+    int32 PopulateGridContinents(TArray<int32>& OutCellsPerContinent);
+    void UpdateContinentColorLUT(const FContinentClassifier& Classifier);
+
+    // Genera i seed dei territori per ogni continente (Poisson-disk deterministico, distribuzione blue-noise).
+    // Ritorna il numero di seed (= ID successivo).
+    int32 GenerateTerritorySeeds(TArray<FGridSeed>& OutSeeds);
+
+    // Voronoi completo con l'algoritmo scelto (assegna Territory e Height a ogni cella)
+    void RunVoronoi(const TArray<FGridSeed>& Seeds, EVoronoiAlgorithm Algorithm);
+
+    // Jump Flood Algorithm (condiviso tra sync e async)
+    void InitJumpFlood(const TArray<FGridSeed>& Seeds);
+    void RunJumpFloodPass(const TArray<FGridSeed>& Seeds, int32 JumpSize); // Un passo, ParallelFor sulle righe
+
+    // Distance transform euclideo esatto (separabile, colonne poi righe in parallelo) -> SeedIndex
+    void RunExactDistanceTransform(const TArray<FGridSeed>& Seeds);
+
+    void AssignTerritoriesFromSeedIndex(const TArray<FGridSeed>& Seeds); // Dopo JFA o EDT
+    void AssignTerritoriesBruteForce(const TArray<FGridSeed>& Seeds);
+
+    // Inizializza GeneratedData (ID, colori, nomi, centro) dai seed
+    void InitTerritoryMetadata(const TArray<FGridSeed>& Seeds);
+
+    // Costruisce il grafo di adiacenza CSR con uno scan della griglia e riempie NeighborIDs
+    void BuildTerritoryAdjacency();
+
+    // Costruisce la mesh voxel di ogni territorio leggendo la griglia (condiviso tra sync e async).
+    // Un task per territorio (ParallelFor), stesso output della versione seriale.
+    void BuildTerritoryGeometry();
+    void BucketCellsByTerritory(FTerritoryCellBuckets& OutBuckets) const;
+    void UpdateGeometryStats(); // Conteggi territori/vertici/triangoli in PipelineStats
+    void BuildTerritoryGeometryPerCell(FTerritoryMeshBuilder& Builder, int16 TerritoryID, TArrayView<const FCellSpan> Spans) const; // Un quad superiore per cella + facce laterali
+    void BuildTerritoryGeometryGreedy(FTerritoryMeshBuilder& Builder, int16 TerritoryID, TArrayView<const FCellSpan> Spans, const FIntRect& Bounds) const; // Rettangoli massimali complanari + strisce laterali
+
     void SpawnVisuals();
+    void SpawnTerritoryActor(int32 TerritoryIndex); // Spawn + upload mesh (la mesh del territorio viene liberata)
+    void ReleaseTerritoryMeshes();
     void DrawDebugVisuals();
 
+    // --- Modalità solo logica (dedicated server / -nullrhi) ---
+    bool ShouldGenerateLogicOnly() const;
+    void ReleaseRenderData(); // Libera griglia e mesh dopo il partizionamento (o dopo un load da cache)
+
+    // --- Cache su disco (Saved/MapCache) ---
+    FMapCache::FKey MakeCacheKey() const;
+    bool TryLoadFromCache();   // true = griglia, adiacenza e GeneratedData caricati, si passa allo spawn
+    void SaveToCache();
+    bool SerializeCachedMap(FArchive& Ar); // Stesso codice per lettura e scrittura
+
     // --- Passaggi interni (ASINCRONO) ---
     void ProcessAsyncTick(); // Chiamato da Tick() quando AsyncState != Idle
     void UpdateAsyncProgress(float NewProgress, const FString& StatusText);
     void CompleteAsyncGeneration();
 
-    // Step functions (ogni step esegue parte della generazione)
+    // Pipeline eseguita da GenerationTask (worker thread)
+    void RunGenerationPipeline();
+    bool IsPipelineCanceled() const { return bCancelRequested.load(std::memory_order_relaxed); }
+
+    // Dal worker: esegue Func sul game thread, solo se la generazione è ancora quella corrente
+    void RunOnGameThreadIfCurrent(TUniqueFunction<void(AMapGenerator&)> Func);
+    void ReportAsyncProgress(EMapGenerationState NewState, float NewProgress, const FString& StatusText,
+                             TOptional<FMapGenerationStats> PublishedStats = {});
+
+    // Ferma e aspetta il task (game thread), anche se la generazione non risulta più in corso
+    void StopGenerationTask();
+
+    // Step functions: tutte sul worker tranne AsyncStep_SpawnVisuals (game thread, a chunk)
     void AsyncStep_Initialize();
     void AsyncStep_PopulateGrid();
-    void AsyncStep_GenerateSeeds();
-    void AsyncStep_VoronoiIteration();
+    bool AsyncStep_GenerateSeeds(); // false se i territori superano il piano int16
+    void AsyncStep_Voronoi();
     void AsyncStep_BuildGeometry();
     void AsyncStep_SpawnVisuals();
 
-    // Helper per generazione mesh
-    void AddQuadFace(FGeneratedTerritory& Data, const FVector& V1, const FVector& V2, const FVector& Normal, const FLinearColor& Color);
-
-    // Helper per accedere alle celle della griglia
-    FORCEINLINE FVoxelCell* GetCell(int32 X, int32 Y)
+    // Helper per accedere alle celle della griglia (INDEX_NONE se fuori griglia)
+    FORCEINLINE int32 GetCellIndex(int32 X, int32 Y) const
     {
         if (X >= 0 && X < GridSizeX && Y >= 0 && Y < GridSizeY)
         {
-            return &VoxelGrid[Y * GridSizeX + X];
+            return Y * GridSizeX + X;
         }
-        return nullptr;
+        return INDEX_NONE;
+    }
+
+    // Una faccia laterale serve se il vicino è fuori griglia, di un altro territorio o con dislivello
+    FORCEINLINE bool NeedsSideFace(int32 NeighborIdx, int16 TerritoryID, int16 HeightQ, int16 HeightThresholdQ) const
+    {
+        return NeighborIdx == INDEX_NONE
+            || VoxelGrid.Territory[NeighborIdx] != TerritoryID
+            || FMath::Abs((int32)VoxelGrid.Height[NeighborIdx] - (int32)HeightQ) > HeightThresholdQ;
     }
 };
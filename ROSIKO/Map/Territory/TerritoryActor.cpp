@@ -1,10 +1,10 @@
 #include "TerritoryActor.h"
+#include "TerritoryRegistrySubsystem.h"
 #include "./UI/TerritoryInfoWidget.h"
 #include "../../Troop/UI/TroopDisplayComponent.h"
 #include "../../Troop/UI/TroopVisualManager.h"
 #include "Blueprint/UserWidget.h"
 #include "Blueprint/WidgetBlueprintLibrary.h"
-#include "EngineUtils.h"
 
 // Log Category
 DEFINE_LOG_CATEGORY_STATIC(LogRosikoTerritoryActor, Log, All);
@@ -24,6 +24,9 @@ ATerritoryActor::ATerritoryActor()
 	TerritoryMesh->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block); // Per il mouse click
 	TerritoryMesh->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
 
+	// Cooking della collisione fuori dal game thread (evita hitch allo spawn della mappa)
+	TerritoryMesh->bUseAsyncCooking = true;
+
 	// Crea il componente display carri (widget 3D) - LEGACY
 	TroopDisplay = CreateDefaultSubobject<UTroopDisplayComponent>(TEXT("TroopDisplay"));
 	TroopDisplay->SetupAttachment(RootComponent);
@@ -44,6 +47,19 @@ void ATerritoryActor::BeginPlay()
 	Super::BeginPlay();
 }
 
+void ATerritoryActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWorld* World = GetWorld())
+	{
+		if (UTerritoryRegistrySubsystem* Registry = World->GetSubsystem<UTerritoryRegistrySubsystem>())
+		{
+			Registry->UnregisterTerritory(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void ATerritoryActor::NotifyActorOnClicked(FKey ButtonPressed)
 {
 	Super::NotifyActorOnClicked(ButtonPressed);
@@ -97,6 +113,15 @@ void ATerritoryActor::SetTerritoryData(const FGeneratedTerritory& Data)
 	TerritoryData = Data;
 }
 
+void ATerritoryActor::UploadMesh(const FGeneratedTerritoryMesh& Mesh)
+{
+	if (TerritoryMesh && Mesh.Vertices.Num() > 0)
+	{
+		TerritoryMesh->CreateMeshSection_LinearColor(0, Mesh.Vertices, Mesh.Triangles, Mesh.Normals,
+			TArray<FVector2D>(), Mesh.VertexColors, TArray<FProcMeshTangent>(), true);
+	}
+}
+
 void ATerritoryActor::HighlightTerritory_Implementation(bool bHighlight)
 {
 	bIsHighlighted = bHighlight;
@@ -150,16 +175,11 @@ UTerritoryInfoWidget* ATerritoryActor::FindInfoWidget()
 
 void ATerritoryActor::DeselectOtherTerritories()
 {
-	// Itera tutti i TerritoryActor nel mondo e deselezionali
+	// Deseleziona tutti gli altri territori registrati (niente scan degli actor del mondo)
 	int32 DeselectedCount = 0;
-	for (TActorIterator<ATerritoryActor> It(GetWorld()); It; ++It)
+	if (UTerritoryRegistrySubsystem* Registry = GetWorld()->GetSubsystem<UTerritoryRegistrySubsystem>())
 	{
-		ATerritoryActor* Territory = *It;
-		if (Territory && Territory != this && Territory->IsSelected())
-		{
-			Territory->Deselect();
-			DeselectedCount++;
-		}
+		DeselectedCount = Registry->DeselectAll(this);
 	}
 	UE_LOG(LogRosikoTerritoryActor, Log, TEXT("Deselected %d other territories"), DeselectedCount);
 }
@@ -18,6 +18,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 	// Gestione click
 	virtual void NotifyActorOnClicked(FKey ButtonPressed) override;
@@ -35,21 +36,25 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Territory")
 	class UTroopVisualManager* TroopVisualManager;
 
-	// Dati del territorio (geometria + logica di gioco)
+	// Dati del territorio (metadati + logica di gioco; la geometria vive solo in TerritoryMesh)
 	UPROPERTY(BlueprintReadOnly, Category = "Territory")
 	FGeneratedTerritory TerritoryData;
 
-	// Called to initialize the territory visual
+	// Setup visivo lato Blueprint (materiali, effetti). La mesh è già stata caricata da UploadMesh.
 	UFUNCTION(BlueprintImplementableEvent, Category = "Territory")
 	void InitializeMesh(const FGeneratedTerritory& Data);
 
+	// Carica la geometria generata nella sezione 0 di TerritoryMesh (chiamato da MapGenerator).
+	// Il componente copia gli array: il chiamante può liberare Mesh subito dopo.
+	void UploadMesh(const FGeneratedTerritoryMesh& Mesh);
+
 	// Imposta i dati del territorio (chiamato da MapGenerator)
 	UFUNCTION(BlueprintCallable, Category = "Territory")
 	void SetTerritoryData(const FGeneratedTerritory& Data);
 
 	// Restituisce i dati del territorio
 	UFUNCTION(BlueprintPure, Category = "Territory")
-	FGeneratedTerritory GetTerritoryData() const { return TerritoryData; }
+	const FGeneratedTerritory& GetTerritoryData() const { return TerritoryData; }
 
 	// Evidenzia visivamente il territorio (chiamato quando viene selezionato)
 	UFUNCTION(BlueprintNativeEvent, Category = "Territory")
@@ -0,0 +1,61 @@
+#include "TerritoryRegistrySubsystem.h"
+#include "TerritoryActor.h"
+
+// Log Category
+DEFINE_LOG_CATEGORY_STATIC(LogRosikoTerritoryRegistry, Log, All);
+
+void UTerritoryRegistrySubsystem::Deinitialize()
+{
+	Territories.Empty();
+
+	Super::Deinitialize();
+}
+
+void UTerritoryRegistrySubsystem::RegisterTerritory(ATerritoryActor* Territory)
+{
+	if (!Territory)
+	{
+		return;
+	}
+
+	const int32 TerritoryID = Territory->GetTerritoryData().ID;
+	if (TerritoryID < 0)
+	{
+		UE_LOG(LogRosikoTerritoryRegistry, Warning, TEXT("RegisterTerritory: %s has invalid TerritoryID %d"), *Territory->GetName(), TerritoryID);
+		return;
+	}
+
+	if (TerritoryID >= Territories.Num())
+	{
+		Territories.SetNum(TerritoryID + 1);
+	}
+	Territories[TerritoryID] = Territory;
+}
+
+void UTerritoryRegistrySubsystem::UnregisterTerritory(ATerritoryActor* Territory)
+{
+	if (!Territory)
+	{
+		return;
+	}
+
+	const int32 TerritoryID = Territory->GetTerritoryData().ID;
+	if (Territories.IsValidIndex(TerritoryID) && Territories[TerritoryID] == Territory)
+	{
+		Territories[TerritoryID] = nullptr;
+	}
+}
+
+int32 UTerritoryRegistrySubsystem::DeselectAll(const ATerritoryActor* Except)
+{
+	int32 DeselectedCount = 0;
+	for (ATerritoryActor* Territory : Territories)
+	{
+		if (Territory && Territory != Except && Territory->IsSelected())
+		{
+			Territory->Deselect();
+			DeselectedCount++;
+		}
+	}
+	return DeselectedCount;
+}
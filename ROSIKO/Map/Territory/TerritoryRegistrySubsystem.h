@@ -0,0 +1,46 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TerritoryRegistrySubsystem.generated.h"
+
+class ATerritoryActor;
+
+/**
+ * Registro TerritoryID -> ATerritoryActor per il mondo corrente.
+ * Array denso indicizzato per ID (gli ID territorio sono compatti 0..N-1): lookup O(1),
+ * senza TActorIterator sull'intero mondo né copie di FGeneratedTerritory.
+ *
+ * Popolato da AMapGenerator allo spawn; ogni TerritoryActor si deregistra in EndPlay.
+ */
+UCLASS()
+class ROSIKO_API UTerritoryRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Registra l'actor sotto TerritoryData.ID (sostituisce un eventuale actor precedente con lo stesso ID)
+	void RegisterTerritory(ATerritoryActor* Territory);
+
+	// Rimuove l'actor se è ancora quello registrato per il suo ID
+	void UnregisterTerritory(ATerritoryActor* Territory);
+
+	// Actor del territorio, nullptr se non spawnato (oceano, generazione solo logica, ID non valido)
+	UFUNCTION(BlueprintPure, Category = "Territory")
+	ATerritoryActor* FindTerritory(int32 TerritoryID) const
+	{
+		return Territories.IsValidIndex(TerritoryID) ? Territories[TerritoryID].Get() : nullptr;
+	}
+
+	// Tutti gli slot indicizzati per ID (possono contenere nullptr)
+	const TArray<TObjectPtr<ATerritoryActor>>& GetTerritories() const { return Territories; }
+
+	// Deseleziona tutti i territori registrati tranne Except; ritorna quanti sono stati deselezionati
+	int32 DeselectAll(const ATerritoryActor* Except = nullptr);
+
+private:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ATerritoryActor>> Territories;
+};
@@ -1,5 +1,6 @@
 #include "TerritoryInfoWidget.h"
 #include "../TerritoryActor.h"
+#include "../TerritoryRegistrySubsystem.h"
 #include "../../../Core/RosikoGameManager.h"
 #include "../../MapGenerator.h"
 #include "EngineUtils.h"
@@ -25,13 +26,9 @@ FReply UTerritoryInfoWidget::NativeOnMouseButtonDown(const FGeometry& InGeometry
 		UWorld* World = GetWorld();
 		if (World)
 		{
-			for (TActorIterator<ATerritoryActor> It(World); It; ++It)
+			if (UTerritoryRegistrySubsystem* Registry = World->GetSubsystem<UTerritoryRegistrySubsystem>())
 			{
-				ATerritoryActor* Territory = *It;
-				if (Territory && Territory->IsSelected())
-				{
-					Territory->Deselect();
-				}
+				Registry->DeselectAll();
 			}
 		}
 
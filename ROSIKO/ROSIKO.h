@@ -3,4 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
 
+// "stat Rosiko": generazione mappa, game manager, visual delle truppe
+DECLARE_STATS_GROUP(TEXT("Rosiko"), STATGROUP_Rosiko, STATCAT_Advanced);
+
+// Scope per Unreal Insights + contatore del gruppo Rosiko con lo stesso nome (STAT_xxx dichiarato con DECLARE_CYCLE_STAT)
+#define ROSIKO_SCOPE_CYCLE_COUNTER(Stat) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(Stat); \
+	SCOPE_CYCLE_COUNTER(Stat)
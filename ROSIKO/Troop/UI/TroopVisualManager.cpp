@@ -1,4 +1,5 @@
 #include "TroopVisualManager.h"
+#include "../../ROSIKO.h"
 #include "TroopDisplayComponent.h"
 #include "../../Core/Camera/RosikoCamera.h"
 #include "Materials/MaterialInstanceDynamic.h"
@@ -10,6 +11,15 @@
 
 DEFINE_LOG_CATEGORY_STATIC(LogTroopVisualManager, Log, All);
 
+DECLARE_CYCLE_STAT(TEXT("Troops Tick"), STAT_RosikoTroopTick, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Update Display"), STAT_RosikoTroopUpdateDisplay, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Camera Distance"), STAT_RosikoTroopCameraDistance, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Fade Transition"), STAT_RosikoTroopFade, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Update Mesh"), STAT_RosikoTroopUpdateMesh, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Update Instances"), STAT_RosikoTroopUpdateInstances, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Update Colors"), STAT_RosikoTroopUpdateColors, STATGROUP_Rosiko);
+DECLARE_CYCLE_STAT(TEXT("Troops Update Widget"), STAT_RosikoTroopUpdateWidget, STATGROUP_Rosiko);
+
 UTroopVisualManager::UTroopVisualManager()
 {
 	PrimaryComponentTick.bCanEverTick = true;
@@ -94,6 +104,8 @@ void UTroopVisualManager::CreateInstancedMeshComponent()
 
 void UTroopVisualManager::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopTick);
+
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
 	// Aggiorna fade transition se in corso
@@ -223,6 +235,8 @@ void UTroopVisualManager::CreateBaseMaterial()
 
 void UTroopVisualManager::UpdateTroopDisplay(int32 TroopCount, FLinearColor OwnerColor)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopUpdateDisplay);
+
 	// Aggiorna dati solo se cambiati
 	bool bCountChanged = (TroopCount != CurrentTroopCount);
 	bool bColorChanged = !OwnerColor.Equals(CurrentOwnerColor, 0.01f);
@@ -283,6 +297,8 @@ void UTroopVisualManager::ForceRefresh()
 
 void UTroopVisualManager::CheckCameraDistance()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopCameraDistance);
+
 	if (!CachedCamera)
 	{
 		InitializeCamera();
@@ -340,6 +356,8 @@ void UTroopVisualManager::TransitionToMode(ETroopDisplayMode NewMode)
 
 void UTroopVisualManager::UpdateFadeTransition(float DeltaTime)
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopFade);
+
 	// Avanza fade progress
 	if (FadeProgress < 1.0f)
 	{
@@ -412,6 +430,8 @@ void UTroopVisualManager::UpdateFadeTransition(float DeltaTime)
 
 void UTroopVisualManager::UpdateMeshDisplay()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopUpdateMesh);
+
 	if (!TroopInstancedMesh)
 	{
 		UE_LOG(LogTroopVisualManager, Error, TEXT("TroopInstancedMesh is null! Component not created?"));
@@ -458,6 +478,8 @@ void UTroopVisualManager::UpdateMeshDisplay()
 
 void UTroopVisualManager::UpdateInstanceTransforms()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopUpdateInstances);
+
 	if (!TroopInstancedMesh || InstanceTransforms.Num() == 0) return;
 
 	// Batch update: NON marcare dirty per ogni istanza (false, false, false)
@@ -474,6 +496,8 @@ void UTroopVisualManager::UpdateInstanceTransforms()
 
 void UTroopVisualManager::UpdateInstanceColors()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopUpdateColors);
+
 	if (!TroopMaterialInstance) return;
 
 	// Imposta colore nel material (applicato a tutte le istanze)
@@ -493,6 +517,8 @@ void UTroopVisualManager::ClearAllInstances()
 
 void UTroopVisualManager::UpdateWidgetDisplay()
 {
+	ROSIKO_SCOPE_CYCLE_COUNTER(STAT_RosikoTroopUpdateWidget);
+
 	if (!WidgetComponent)
 	{
 		UE_LOG(LogTroopVisualManager, Warning, TEXT("UpdateWidgetDisplay: WidgetComponent is NULL!"));